@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+#
+# Generates the mesh benchmark netlists in bench/<family>/.
+#
+# A mesh is a ring of flip-flops, each fed by a LUT of its two neighbours, a
+# flip-flop far across the ring and an input pin, with a few flip-flops
+# driving output pins. The netlists are written in the JSON format of
+# yosys, using the cells the synthesis flow of each family emits, so that
+# nextpnr can load them without running yosys. The far connections are
+# chosen with a fixed seed, so the output is always the same.
+
+import json
+import random
+from os import path
+
+# LUT and flip-flop cells of each family, as (type, input ports, output
+# port, init parameter) and (type, clock port, data port, output port,
+# parameters).
+families = {
+    "ice40": {
+        "lut": ("SB_LUT4", ["I0", "I1", "I2", "I3"], "O", "LUT_INIT"),
+        "ff": ("SB_DFF", "C", "D", "Q", {}),
+    },
+    "ecp5": {
+        "lut": ("LUT4", ["A", "B", "C", "D"], "Z", "INIT"),
+        "ff": ("TRELLIS_FF", "CLK", "DI", "Q", {
+            "GSR": "DISABLED",
+            "CEMUX": "1",
+            "CLKMUX": "CLK",
+            "LSRMUX": "LSR",
+            "REGSET": "RESET",
+            "SRMODE": "LSR_OVER_CE",
+        }),
+    },
+}
+
+# Netlists to generate, as (family, name, flip-flops, input pins, output
+# pins, extra arguments for nextpnr).
+meshes = [
+    ("ice40", "mesh_large", 3000, 8, 8, "--hx8k"),
+    ("ecp5", "mesh_small", 256, 4, 4, "--25k"),
+    ("ecp5", "mesh_large", 8000, 8, 8, "--45k"),
+]
+
+
+def mesh(family, name, size, inputs, outputs):
+    lut_type, lut_inputs, lut_output, lut_init = families[family]["lut"]
+    ff_type, ff_clock, ff_data, ff_output, ff_params = families[family]["ff"]
+    rng = random.Random(size)
+
+    # Bits 0 and 1 are reserved by yosys for constants.
+    clk = 2
+    din = list(range(3, 3 + inputs))
+    q = list(range(3 + inputs, 3 + inputs + size))
+    d = list(range(3 + inputs + size, 3 + inputs + 2 * size))
+
+    cells = {}
+    for i in range(size):
+        far = (i + size // 2 + rng.randrange(-size // 8, size // 8 + 1)) % size
+        cells["lut_{}".format(i)] = {
+            "hide_name": 0,
+            "type": lut_type,
+            "parameters": {lut_init: rng.randrange(1, 65535)},
+            "attributes": {},
+            "port_directions": dict([(p, "input") for p in lut_inputs] + [(lut_output, "output")]),
+            "connections": dict(
+                list(zip(lut_inputs, [[q[(i - 1) % size]], [q[(i + 1) % size]], [q[far]], [din[i % inputs]]])) +
+                [(lut_output, [d[i]])]),
+        }
+        cells["ff_{}".format(i)] = {
+            "hide_name": 0,
+            "type": ff_type,
+            "parameters": dict(ff_params),
+            "attributes": {},
+            "port_directions": {ff_clock: "input", ff_data: "input", ff_output: "output"},
+            "connections": {ff_clock: [clk], ff_data: [d[i]], ff_output: [q[i]]},
+        }
+
+    out = [q[i * size // outputs] for i in range(outputs)]
+    ports = {
+        "clk": {"direction": "input", "bits": [clk]},
+        "din": {"direction": "input", "bits": din},
+        "dout": {"direction": "output", "bits": out},
+    }
+    netnames = {
+        "clk": {"hide_name": 0, "bits": [clk], "attributes": {}},
+        "din": {"hide_name": 0, "bits": din, "attributes": {}},
+        "dout": {"hide_name": 0, "bits": out, "attributes": {}},
+        "q": {"hide_name": 0, "bits": q, "attributes": {}},
+        "d": {"hide_name": 0, "bits": d, "attributes": {}},
+    }
+    return {
+        "creator": "bench/generate_mesh.py",
+        "modules": {
+            name: {
+                "attributes": {"top": 1},
+                "ports": ports,
+                "cells": cells,
+                "netnames": netnames,
+            }
+        },
+    }
+
+
+bench = path.dirname(path.abspath(__file__))
+for family, name, size, inputs, outputs, extra_args in meshes:
+    with open(path.join(bench, family, name + ".json"), "w") as f:
+        json.dump(mesh(family, name, size, inputs, outputs), f, separators=(",", ":"), sort_keys=True)
+        f.write("\n")
+    with open(path.join(bench, family, name + ".args"), "w") as f:
+        f.write(extra_args + "\n")
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+#
+# Benchmark harness for the nextpnr place and route engines.
+#
+# Runs every pre-synthesised netlist in a directory through a nextpnr binary
+# with several seeds, using --report-perf to collect the time and memory of
+# each phase along with wirelength and Fmax, and reports their distribution.
+# Only nextpnr itself is needed, so it runs offline without yosys or icetime.
+#
+# Each netlist <name>.json may have a <name>.args file next to it, holding
+# extra arguments for nextpnr such as the device and constraints file. Paths
+# in it are relative to the netlist directory.
+
+import argparse
+import json
+import os
+import shlex
+import statistics
+import subprocess
+import sys
+import tempfile
+from concurrent.futures import ThreadPoolExecutor
+from os import path
+
+parser = argparse.ArgumentParser(description="benchmark nextpnr on a set of netlists")
+parser.add_argument("--binary", type=str, required=True, help="nextpnr binary to benchmark")
+parser.add_argument("--netlists", type=str, required=True, help="directory of pre-synthesised JSON netlists")
+parser.add_argument("--seeds", type=int, default=5, help="number of seeds to run each netlist with")
+parser.add_argument("--jobs", type=int, default=1,
+                    help="runs to do at once; more than one makes timings less reliable")
+parser.add_argument("--output", type=str, help="JSON file to write the results to")
+args = parser.parse_args()
+
+# Gauges reported, as (name, key in the report).
+gauges = [
+    ("wirelength", "place/wirelength"),
+    ("routed_wires", "route/wires"),
+    ("fmax_mhz", "sta/fmax_mhz"),
+    ("moves_per_sec", "place/moves_per_sec"),
+    ("route_jobs_per_sec", "route/jobs_per_sec"),
+]
+
+
+def run(netlist, extra_args, seed):
+    with tempfile.TemporaryDirectory() as work:
+        report = path.join(work, "perf.json")
+        log = path.join(work, "nextpnr.log")
+        cmd = [path.abspath(args.binary), "--json", netlist, "--seed", str(seed), "--report-perf", report]
+        cmd += extra_args
+        with open(log, "w") as logf:
+            result = subprocess.run(cmd, cwd=args.netlists, stdout=logf, stderr=subprocess.STDOUT)
+        if result.returncode != 0 or not path.exists(report):
+            with open(log) as logf:
+                tail = logf.readlines()[-10:]
+            return None, "".join(tail)
+        with open(report) as f:
+            return json.load(f), None
+
+
+def metrics(report):
+    result = {}
+    for name, phase in sorted(report["phases"].items()):
+        result["time/" + name] = phase["seconds"]
+    result["peak_rss_mb"] = report["peak_rss_bytes"] / (1024 * 1024)
+    for name, key in gauges:
+        if report["gauges"].get(key) is not None:
+            result[name] = report["gauges"][key]
+    return result
+
+
+def summarise(values):
+    return {
+        "min": min(values),
+        "median": statistics.median(values),
+        "mean": statistics.mean(values),
+        "max": max(values),
+    }
+
+
+netlists = sorted(f for f in os.listdir(args.netlists) if f.endswith(".json")) if path.isdir(args.netlists) else []
+if len(netlists) == 0:
+    print("No netlists found in {}; add pre-synthesised JSON netlists there to benchmark.".format(args.netlists))
+    sys.exit(1)
+
+runs = []
+for netlist in netlists:
+    extra_args = []
+    args_file = path.join(args.netlists, netlist[:-len(".json")] + ".args")
+    if path.exists(args_file):
+        with open(args_file) as f:
+            extra_args = shlex.split(f.read())
+    for seed in range(1, args.seeds + 1):
+        runs.append((netlist, extra_args, seed))
+
+with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+    reports = list(pool.map(lambda r: run(*r), runs))
+
+results = {}
+failed = 0
+for (netlist, extra_args, seed), (report, error) in zip(runs, reports):
+    design = results.setdefault(netlist[:-len(".json")], {"runs": 0, "failed_seeds": [], "metrics": {}})
+    design["runs"] += 1
+    if report is None:
+        print("{} failed with seed {}:\n{}".format(netlist, seed, error), file=sys.stderr)
+        design["failed_seeds"].append(seed)
+        failed += 1
+        continue
+    for name, value in metrics(report).items():
+        design["metrics"].setdefault(name, []).append(value)
+
+for design in results.values():
+    design["metrics"] = {name: summarise(values) for name, values in sorted(design["metrics"].items())}
+
+for name, design in sorted(results.items()):
+    print("{}: {}/{} runs passed".format(name, design["runs"] - len(design["failed_seeds"]), design["runs"]))
+    print("  {:<32} {:>12} {:>12} {:>12} {:>12}".format("metric", "min", "median", "mean", "max"))
+    for metric, s in design["metrics"].items():
+        print("  {:<32} {:>12.3f} {:>12.3f} {:>12.3f} {:>12.3f}".format(metric, s["min"], s["median"], s["mean"],
+                                                                       s["max"]))
+
+if args.output:
+    with open(args.output, "w") as f:
+        json.dump({"seeds": args.seeds, "designs": results}, f, indent=2, sort_keys=True)
+
+sys.exit(1 if failed > 0 else 0)
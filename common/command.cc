@@ -31,10 +31,13 @@
 #include <boost/program_options.hpp>
 #include <fstream>
 #include <iostream>
+#include <thread>
 #include "command.h"
 #include "design_utils.h"
 #include "jsonparse.h"
 #include "log.h"
+#include "seed_sweep.h"
+#include "telemetry.h"
 #include "timing.h"
 #include "version.h"
 
@@ -75,6 +78,10 @@ bool CommandHandler::executeBeforeContext()
                   << " -- Next Generation Place and Route (git sha1 " GIT_COMMIT_HASH_STR ")\n";
         return true;
     }
+#ifndef NO_PYTHON
+    // The design is placed and routed in clones that Python scripts can't see
+    conflicting_options(vm, "parallel-seeds", "pre-route");
+#endif
     validate();
     return false;
 }
@@ -104,7 +111,13 @@ po::options_description CommandHandler::getGeneralOptions()
     general.add_options()("seed", po::value<int>(), "seed value for random number generator");
     general.add_options()("slack_redist_iter", po::value<int>(), "number of iterations between slack redistribution");
     general.add_options()("cstrweight", po::value<float>(), "placer weighting for relative constraint satisfaction");
+    general.add_options()("placer-adaptive", "use an adaptive annealing schedule in the placer");
     general.add_options()("pack-only", "pack design only without placement or routing");
+    general.add_options()("parallel-seeds", po::value<int>(),
+                          "place and route with this many seeds from --seed up in parallel, keeping the best result");
+    general.add_options()("threads", po::value<int>(),
+                          "number of threads for --parallel-seeds (default: all cores), or else for routing "
+                          "(default: 1)");
 
     general.add_options()("version,V", "show version");
     general.add_options()("test", "check architecture database integrity");
@@ -112,6 +125,7 @@ po::options_description CommandHandler::getGeneralOptions()
     general.add_options()("no-tmdriv", "disable timing-driven placement");
     general.add_options()("save", po::value<std::string>(), "project file to write");
     general.add_options()("load", po::value<std::string>(), "project file to read");
+    general.add_options()("report-perf", po::value<std::string>(), "JSON file to write performance telemetry to");
     return general;
 }
 
@@ -153,6 +167,15 @@ void CommandHandler::setupContext(Context *ctx)
         settings->set("placer1/constraintWeight", vm["cstrweight"].as<float>());
     }
 
+    if (vm.count("placer-adaptive")) {
+        settings->set("placer1/adaptiveSchedule", true);
+    }
+
+    // Parallel seeds already use the threads, each routing on one
+    if (vm.count("threads") && !vm.count("parallel-seeds")) {
+        settings->set("router1/threads", vm["threads"].as<int>());
+    }
+
     if (vm.count("freq")) {
         auto freq = vm["freq"].as<double>();
         if (freq > 0)
@@ -166,6 +189,7 @@ void CommandHandler::setupContext(Context *ctx)
 
 int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
 {
+    std::unique_ptr<Context> packed_ctx;
     if (vm.count("test")) {
         ctx->archcheck();
         return 0;
@@ -198,6 +222,7 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
     }
 #endif
     if (vm.count("json")) {
+        TelemetryPhase phase("load");
         std::string filename = vm["json"].as<std::string>();
         std::ifstream f(filename);
         if (!parse_json_file(f, filename, ctx.get()))
@@ -219,24 +244,57 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
 #endif
             if (vm.count("json") || vm.count("load")) {
         run_script_hook("pre-pack");
-        if (!ctx->pack() && !ctx->force)
-            log_error("Packing design failed.\n");
+        {
+            TelemetryPhase phase("pack");
+            if (!ctx->pack() && !ctx->force)
+                log_error("Packing design failed.\n");
+        }
         assign_budget(ctx.get());
         ctx->check();
         print_utilisation(ctx.get());
         run_script_hook("pre-place");
 
-        if (!vm.count("pack-only")) {
-            if (!ctx->place() && !ctx->force)
-                log_error("Placing design failed.\n");
+        if (vm.count("parallel-seeds") && !vm.count("pack-only")) {
+            int count = vm["parallel-seeds"].as<int>();
+            if (count < 1)
+                log_error("--parallel-seeds must be at least 1.\n");
+            int first_seed = vm.count("seed") ? vm["seed"].as<int>() : 1;
+            std::vector<int> seeds;
+            for (int i = 0; i < count; i++)
+                seeds.push_back(first_seed + i);
+            int threads = vm.count("threads") ? vm["threads"].as<int>() : int(std::thread::hardware_concurrency());
+
+            std::unique_ptr<Context> best;
+            {
+                TelemetryPhase phase("seeds");
+                best = place_and_route_seeds(ctx.get(), seeds, threads);
+            }
+            if (best == nullptr)
+                log_error("Placing and routing design failed with every seed.\n");
+            // Keep the packed design alive, as Python may still refer to it
+            packed_ctx = std::move(ctx);
+            ctx = std::move(best);
+#ifndef NO_PYTHON
+            python_export_global("ctx", *ctx);
+#endif
+        } else if (!vm.count("pack-only")) {
+            {
+                TelemetryPhase phase("place");
+                if (!ctx->place() && !ctx->force)
+                    log_error("Placing design failed.\n");
+            }
             ctx->check();
             run_script_hook("pre-route");
 
-            if (!ctx->route() && !ctx->force)
-                log_error("Routing design failed.\n");
+            {
+                TelemetryPhase phase("route");
+                if (!ctx->route() && !ctx->force)
+                    log_error("Routing design failed.\n");
+            }
         }
         run_script_hook("post-route");
 
+        TelemetryPhase phase("bitstream");
         customBitstream(ctx.get());
     }
 
@@ -244,6 +302,14 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
         project.save(ctx.get(), vm["save"].as<std::string>());
     }
 
+    if (vm.count("report-perf")) {
+        std::string filename = vm["report-perf"].as<std::string>();
+        std::ofstream f(filename);
+        if (!f)
+            log_error("Failed to open performance report file '%s' for writing.\n", filename.c_str());
+        telemetry_write_json(f);
+    }
+
 #ifndef NO_PYTHON
     deinit_python();
 #endif
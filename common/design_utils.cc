@@ -25,7 +25,8 @@
 #include "util.h"
 NEXTPNR_NAMESPACE_BEGIN
 
-void replace_port(CellInfo *old_cell, IdString old_name, CellInfo *rep_cell, IdString rep_name)
+void replace_port(CellInfo *old_cell, IdString old_name, CellInfo *rep_cell, IdString rep_name,
+                  NetlistTransaction *tx)
 {
     PortInfo &old = old_cell->ports.at(old_name);
     PortInfo &rep = rep_cell->ports.at(rep_name);
@@ -39,7 +40,9 @@ void replace_port(CellInfo *old_cell, IdString old_name, CellInfo *rep_cell, IdS
             rep.net->driver.port = rep_name;
         }
     } else if (rep.type == PORT_IN) {
-        if (rep.net != nullptr) {
+        if (rep.net != nullptr && tx != nullptr) {
+            tx->move_user(rep.net, old_cell, old_name, rep_cell, rep_name);
+        } else if (rep.net != nullptr) {
             for (PortRef &load : rep.net->users) {
                 if (load.cell == old_cell && load.port == old_name) {
                     load.cell = rep_cell;
@@ -75,7 +78,7 @@ void print_utilisation(const Context *ctx)
 }
 
 // Connect a net to a port
-void connect_port(const Context *ctx, NetInfo *net, CellInfo *cell, IdString port_name)
+void connect_port(const Context *ctx, NetInfo *net, CellInfo *cell, IdString port_name, NetlistTransaction *tx)
 {
     if (net == nullptr)
         return;
@@ -86,6 +89,8 @@ void connect_port(const Context *ctx, NetInfo *net, CellInfo *cell, IdString por
         NPNR_ASSERT(net->driver.cell == nullptr);
         net->driver.cell = cell;
         net->driver.port = port_name;
+    } else if (port.type == PORT_IN && tx != nullptr) {
+        tx->add_user(net, cell, port_name);
     } else if (port.type == PORT_IN) {
         PortRef user;
         user.cell = cell;
@@ -96,12 +101,14 @@ void connect_port(const Context *ctx, NetInfo *net, CellInfo *cell, IdString por
     }
 }
 
-void disconnect_port(const Context *ctx, CellInfo *cell, IdString port_name)
+void disconnect_port(const Context *ctx, CellInfo *cell, IdString port_name, NetlistTransaction *tx)
 {
     if (!cell->ports.count(port_name))
         return;
     PortInfo &port = cell->ports.at(port_name);
-    if (port.net != nullptr) {
+    if (port.net != nullptr && tx != nullptr) {
+        tx->remove_user(port.net, cell, port_name);
+    } else if (port.net != nullptr) {
         port.net->users.erase(std::remove_if(port.net->users.begin(), port.net->users.end(),
                                              [cell, port_name](const PortRef &user) {
                                                  return user.cell == cell && user.port == port_name;
@@ -110,19 +117,95 @@ void disconnect_port(const Context *ctx, CellInfo *cell, IdString port_name)
     }
 }
 
-void connect_ports(Context *ctx, CellInfo *cell1, IdString port1_name, CellInfo *cell2, IdString port2_name)
+void connect_ports(Context *ctx, CellInfo *cell1, IdString port1_name, CellInfo *cell2, IdString port2_name,
+                   NetlistTransaction *tx)
 {
     PortInfo &port1 = cell1->ports.at(port1_name);
     if (port1.net == nullptr) {
         // No net on port1; need to create one
         std::unique_ptr<NetInfo> p1net(new NetInfo());
         p1net->name = ctx->id(cell1->name.str(ctx) + "$conn$" + port1_name.str(ctx));
-        connect_port(ctx, p1net.get(), cell1, port1_name);
+        connect_port(ctx, p1net.get(), cell1, port1_name, tx);
         IdString p1name = p1net->name;
         NPNR_ASSERT(!ctx->cells.count(p1name));
         ctx->nets[p1name] = std::move(p1net);
     }
-    connect_port(ctx, port1.net, cell2, port2_name);
+    connect_port(ctx, port1.net, cell2, port2_name, tx);
+}
+
+CellInfo *NetlistTransaction::add_cell(std::unique_ptr<CellInfo> cell)
+{
+    new_cells.push_back(std::move(cell));
+    return new_cells.back().get();
+}
+
+void NetlistTransaction::remove_cell(IdString name) { removed_cells.insert(name); }
+
+void NetlistTransaction::remove_net(IdString name) { removed_nets.push_back(name); }
+
+void NetlistTransaction::move_user(NetInfo *net, CellInfo *old_cell, IdString old_name, CellInfo *rep_cell,
+                                   IdString rep_name)
+{
+    moved_users[net->name][std::make_pair(old_cell, old_name)] = std::make_pair(rep_cell, rep_name);
+}
+
+void NetlistTransaction::remove_user(NetInfo *net, CellInfo *cell, IdString port_name)
+{
+    moved_users[net->name][std::make_pair(cell, port_name)] = std::make_pair(nullptr, IdString());
+}
+
+void NetlistTransaction::add_user(NetInfo *net, CellInfo *cell, IdString port_name)
+{
+    PortRef user;
+    user.cell = cell;
+    user.port = port_name;
+    added_users[net->name].push_back(user);
+}
+
+void NetlistTransaction::commit()
+{
+    for (auto &net_users : added_users) {
+        auto net = ctx->nets.find(net_users.first);
+        if (net != ctx->nets.end())
+            net->second->users.insert(net->second->users.end(), net_users.second.begin(), net_users.second.end());
+    }
+    // Fix up the users of every rewired net in one pass, following chains of moves made within the transaction
+    for (auto &net_moves : moved_users) {
+        auto net = ctx->nets.find(net_moves.first);
+        if (net == ctx->nets.end())
+            continue;
+        auto &moves = net_moves.second;
+        auto &users = net->second->users;
+        size_t kept = 0;
+        for (size_t i = 0; i < users.size(); i++) {
+            PortRef user = users.at(i);
+            size_t steps = 0;
+            auto fnd = moves.find(std::make_pair(user.cell, user.port));
+            while (fnd != moves.end() && user.cell != nullptr) {
+                NPNR_ASSERT(steps++ <= moves.size());
+                user.cell = fnd->second.first;
+                user.port = fnd->second.second;
+                fnd = moves.find(std::make_pair(user.cell, user.port));
+            }
+            if (user.cell != nullptr)
+                users.at(kept++) = user;
+        }
+        users.resize(kept);
+    }
+    for (auto net : removed_nets)
+        ctx->nets.erase(net);
+    for (auto cell : removed_cells)
+        ctx->cells.erase(cell);
+    ctx->cells.reserve(ctx->cells.size() + new_cells.size());
+    for (auto &cell : new_cells) {
+        IdString name = cell->name;
+        ctx->cells[name] = std::move(cell);
+    }
+    added_users.clear();
+    moved_users.clear();
+    removed_nets.clear();
+    removed_cells.clear();
+    new_cells.clear();
 }
 
 NEXTPNR_NAMESPACE_END
@@ -31,8 +31,72 @@ NEXTPNR_NAMESPACE_BEGIN
 Utilities for design manipulation, intended for use inside packing algorithms
  */
 
-// Disconnect a net (if connected) from old, and connect it to rep
-void replace_port(CellInfo *old_cell, IdString old_name, CellInfo *rep_cell, IdString rep_name);
+class NetlistTransaction;
+
+// Disconnect a net (if connected) from old, and connect it to rep. If tx is
+// given, updating the net's list of users is deferred until tx is committed
+void replace_port(CellInfo *old_cell, IdString old_name, CellInfo *rep_cell, IdString rep_name,
+                  NetlistTransaction *tx = nullptr);
+
+// Batches the changes made to the netlist by a packing pass, so that they can
+// be applied in a single pass over the cell map and the affected nets when
+// commit() is called, instead of one lookup or user list scan per change.
+// Until then, removed cells and nets stay valid, and the user lists of rewired
+// nets still refer to the old cells and ports. A pass using a transaction must
+// make all its user list changes through it: commit() first appends the added
+// users, then follows the moves made within the transaction, then erases the
+// removed nets and cells and finally adds the new cells.
+class NetlistTransaction
+{
+  public:
+    explicit NetlistTransaction(Context *ctx) : ctx(ctx){};
+
+    // Add a new cell; the returned pointer stays valid after commit
+    CellInfo *add_cell(std::unique_ptr<CellInfo> cell);
+
+    void remove_cell(IdString name);
+    void remove_net(IdString name);
+    bool is_removed(IdString cell_name) const { return removed_cells.count(cell_name); }
+
+    // Move the user old_cell.old_name of a net to rep_cell.rep_name
+    void move_user(NetInfo *net, CellInfo *old_cell, IdString old_name, CellInfo *rep_cell, IdString rep_name);
+
+    // Remove cell.port_name from the users of a net, without touching the port itself
+    void remove_user(NetInfo *net, CellInfo *cell, IdString port_name);
+
+    // Add cell.port_name to the users of a net, without touching the port itself
+    void add_user(NetInfo *net, CellInfo *cell, IdString port_name);
+
+    // Whether any change is waiting to be committed
+    bool empty() const
+    {
+        return new_cells.empty() && removed_nets.empty() && removed_cells.empty() && moved_users.empty() &&
+               added_users.empty();
+    }
+
+    void commit();
+
+  private:
+    typedef std::pair<CellInfo *, IdString> UserKey;
+
+    struct hash_user
+    {
+        std::size_t operator()(const UserKey &arg) const noexcept
+        {
+            std::size_t seed = std::hash<CellInfo *>()(arg.first);
+            seed ^= std::hash<IdString>()(arg.second) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+    };
+
+    Context *ctx;
+    std::vector<std::unique_ptr<CellInfo>> new_cells;
+    std::vector<IdString> removed_nets;
+    std::unordered_set<IdString> removed_cells;
+    // net name -> old user -> new user (nullptr cell to remove the user)
+    std::unordered_map<IdString, std::unordered_map<UserKey, UserKey, hash_user>> moved_users;
+    std::unordered_map<IdString, std::vector<PortRef>> added_users;
+};
 
 // If a net drives a given port of a cell matching a predicate (in many
 // cases more than one cell type, e.g. SB_DFFxx so a predicate is used), return
@@ -82,14 +146,17 @@ template <typename F1> CellInfo *net_driven_by(const Context *ctx, const NetInfo
     }
 }
 
-// Connect a net to a port
-void connect_port(const Context *ctx, NetInfo *net, CellInfo *cell, IdString port_name);
+// Connect a net to a port. If tx is given, adding an input to the net's list
+// of users is deferred until tx is committed
+void connect_port(const Context *ctx, NetInfo *net, CellInfo *cell, IdString port_name,
+                  NetlistTransaction *tx = nullptr);
 
-// Disconnect a net from a port
-void disconnect_port(const Context *ctx, CellInfo *cell, IdString port_name);
+// Disconnect a net from a port, deferring the user list update to tx if given
+void disconnect_port(const Context *ctx, CellInfo *cell, IdString port_name, NetlistTransaction *tx = nullptr);
 
-// Connect two ports together
-void connect_ports(Context *ctx, CellInfo *cell1, IdString port1_name, CellInfo *cell2, IdString port2_name);
+// Connect two ports together, deferring the user list update to tx if given
+void connect_ports(Context *ctx, CellInfo *cell1, IdString port1_name, CellInfo *cell2, IdString port2_name,
+                   NetlistTransaction *tx = nullptr);
 
 void print_utilisation(const Context *ctx);
 
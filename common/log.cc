@@ -43,6 +43,10 @@ bool log_quiet_warnings = false;
 std::string log_last_error;
 void (*log_error_atexit)() = NULL;
 
+// When set, messages logged by the calling thread are appended here instead
+// of being written out, so that work run in parallel keeps its logs apart.
+thread_local std::string *log_capture = nullptr;
+
 // static bool next_print_log = false;
 static int log_newline_count = 0;
 
@@ -102,6 +106,11 @@ void logv(const char *format, va_list ap)
     if (str.empty())
         return;
 
+    if (log_capture != nullptr) {
+        *log_capture += str;
+        return;
+    }
+
     size_t nnl_pos = str.find_last_not_of('\n');
     if (nnl_pos == std::string::npos)
         log_newline_count += str.size();
@@ -142,6 +151,11 @@ void logv_warning_noprefix(const char *format, va_list ap)
 
 void logv_error(const char *format, va_list ap)
 {
+    if (log_capture != nullptr) {
+        *log_capture += "ERROR: " + vstringf(format, ap);
+        throw log_execution_error_exception();
+    }
+
 #ifdef EMSCRIPTEN
     auto backup_log_files = log_files;
 #endif
@@ -48,6 +48,7 @@ extern FILE *log_errfile;
 extern log_write_type log_write_function;
 
 extern bool log_quiet_warnings;
+extern thread_local std::string *log_capture;
 extern std::string log_last_error;
 extern void (*log_error_atexit)();
 
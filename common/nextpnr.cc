@@ -51,6 +51,84 @@ void IdString::initialize_add(const BaseCtx *ctx, const char *s, int idx)
     ctx->idstring_idx_to_str->push_back(&insert_rc.first->first);
 }
 
+void BaseCtx::publishUi()
+{
+    if (!uiAttached()) {
+        uiSnapshotStarted = false;
+        return;
+    }
+    // Nothing was recorded while the UI was away, so start with everything.
+    if (!uiSnapshotStarted) {
+        allUiReload = true;
+        uiSnapshotStarted = true;
+    }
+    if (!allUiReload && !frameUiReload && belUiReload.empty() && wireUiReload.empty() && pipUiReload.empty() &&
+        groupUiReload.empty() && congestionUiReload.empty())
+        return;
+
+    // Build the snapshot before taking the snapshot lock, so that the UI is
+    // never held up by it. A full reload is left to the UI, which queries
+    // every object itself, so only the objects that changed are walked here.
+    const Context *ctx = getCtx();
+    UiSnapshot snapshot;
+    snapshot.full = allUiReload || frameUiReload;
+    if (!snapshot.full) {
+        for (auto bel : belUiReload)
+            snapshot.bels.push_back(std::make_pair(bel, ctx->getBelDecal(bel)));
+        for (auto wire : wireUiReload)
+            snapshot.wires.push_back(std::make_pair(wire, ctx->getWireDecal(wire)));
+        for (auto pip : pipUiReload)
+            snapshot.pips.push_back(std::make_pair(pip, ctx->getPipDecal(pip)));
+        for (auto group : groupUiReload)
+            snapshot.groups.push_back(std::make_pair(group, ctx->getGroupDecal(group)));
+
+        std::unordered_set<DecalId> decals;
+        auto add_graphics = [&](const DecalXY &decal) {
+            if (decal.decal == DecalId() || !decals.insert(decal.decal).second)
+                return;
+            auto graphics = ctx->getDecalGraphics(decal.decal);
+            snapshot.graphics.push_back(
+                    std::make_pair(decal.decal, std::vector<GraphicElement>(graphics.begin(), graphics.end())));
+        };
+        for (auto &bel : snapshot.bels)
+            add_graphics(bel.second);
+        for (auto &wire : snapshot.wires)
+            add_graphics(wire.second);
+        for (auto &pip : snapshot.pips)
+            add_graphics(pip.second);
+        for (auto &group : snapshot.groups)
+            add_graphics(group.second);
+    }
+    std::swap(snapshot.congestion, congestionUiReload);
+    allUiReload = false;
+    frameUiReload = false;
+    belUiReload.clear();
+    wireUiReload.clear();
+    pipUiReload.clear();
+    groupUiReload.clear();
+
+    std::lock_guard<std::mutex> lock(ui_snapshot_mutex);
+    // A full reload makes the changes published before it obsolete, but
+    // congestion scores are only ever sent when they change.
+    if (snapshot.full) {
+        std::vector<std::pair<WireId, int>> congestion;
+        for (auto &old : uiSnapshots)
+            congestion.insert(congestion.end(), old.congestion.begin(), old.congestion.end());
+        congestion.insert(congestion.end(), snapshot.congestion.begin(), snapshot.congestion.end());
+        std::swap(snapshot.congestion, congestion);
+        uiSnapshots.clear();
+    }
+    uiSnapshots.push_back(std::move(snapshot));
+}
+
+std::vector<BaseCtx::UiSnapshot> BaseCtx::takeUiSnapshots()
+{
+    std::vector<UiSnapshot> snapshots;
+    std::lock_guard<std::mutex> lock(ui_snapshot_mutex);
+    std::swap(snapshots, uiSnapshots);
+    return snapshots;
+}
+
 WireId Context::getNetinfoSourceWire(const NetInfo *net_info) const
 {
     if (net_info->driver.cell == nullptr)
@@ -87,6 +165,33 @@ WireId Context::getNetinfoSinkWire(const NetInfo *net_info, const PortRef &user_
     return getBelPinWire(dst_bel, user_port);
 }
 
+// Sum the delay of the routing from src_wire back from dst_wire, if the net is
+// routed all the way
+static bool routed_delay(const Context *ctx, const NetInfo *net_info, WireId src_wire, WireId dst_wire,
+                         delay_t &delay)
+{
+    WireId cursor = dst_wire;
+    delay = 0;
+
+    while (cursor != WireId() && cursor != src_wire) {
+        auto it = net_info->wires.find(cursor);
+
+        if (it == net_info->wires.end())
+            break;
+
+        PipId pip = it->second.pip;
+        delay += ctx->getPipDelay(pip).maxDelay();
+        delay += ctx->getWireDelay(cursor).maxDelay();
+        cursor = ctx->getPipSrcWire(pip);
+    }
+
+    if (cursor != src_wire)
+        return false;
+
+    delay += ctx->getWireDelay(src_wire).maxDelay();
+    return true;
+}
+
 delay_t Context::getNetinfoRouteDelay(const NetInfo *net_info, const PortRef &user_info) const
 {
 #ifdef ARCH_ECP5
@@ -99,25 +204,125 @@ delay_t Context::getNetinfoRouteDelay(const NetInfo *net_info, const PortRef &us
         return 0;
 
     WireId dst_wire = getNetinfoSinkWire(net_info, user_info);
-    WireId cursor = dst_wire;
-    delay_t delay = 0;
 
-    while (cursor != WireId() && cursor != src_wire) {
-        auto it = net_info->wires.find(cursor);
+    // Routes are only ever extended or ripped up, so a complete path found
+    // for this sink stays valid until the net's route generation changes
+    if (user_info.route_gen == net_info->route_gen && user_info.route_src == src_wire &&
+        user_info.route_dst == dst_wire)
+        return user_info.route_delay;
 
-        if (it == net_info->wires.end())
-            break;
+    delay_t delay;
+    if (routed_delay(this, net_info, src_wire, dst_wire, delay))
+        return delay;
 
-        PipId pip = it->second.pip;
-        delay += getPipDelay(pip).maxDelay();
-        delay += getWireDelay(cursor).maxDelay();
-        cursor = getPipSrcWire(pip);
+    return predictDelay(net_info, user_info);
+}
+
+void Context::cacheNetinfoRouteDelays(NetInfo *net_info)
+{
+    WireId src_wire = getNetinfoSourceWire(net_info);
+    if (src_wire == WireId())
+        return;
+
+    for (auto &user_info : net_info->users) {
+        WireId dst_wire = getNetinfoSinkWire(net_info, user_info);
+        delay_t delay;
+        if (!routed_delay(this, net_info, src_wire, dst_wire, delay))
+            continue;
+        user_info.route_gen = net_info->route_gen;
+        user_info.route_src = src_wire;
+        user_info.route_dst = dst_wire;
+        user_info.route_delay = delay;
     }
+}
 
-    if (cursor == src_wire)
-        return delay + getWireDelay(src_wire).maxDelay();
+std::unique_ptr<Context> Context::clone() const
+{
+    std::unique_ptr<Context> copy(new Context(archArgs()));
+
+    // Replicate the ID string database first, so that IdStrings, and the
+    // object IDs made of them, mean the same in both contexts. The IDs the
+    // architecture creates itself are created in the same order by both.
+    for (size_t idx = 1; idx < idstring_idx_to_str->size(); idx++) {
+        IdString id = copy->id(*idstring_idx_to_str->at(idx));
+        NPNR_ASSERT(id.index == int(idx));
+    }
 
-    return predictDelay(net_info, user_info);
+    copy->copyDeviceFrom(*this);
+
+    copy->settings = settings;
+    copy->verbose = verbose;
+    copy->debug = debug;
+    copy->force = force;
+    copy->timing_driven = timing_driven;
+    copy->target_freq = target_freq;
+    copy->auto_freq = auto_freq;
+    copy->slack_redist_iter = slack_redist_iter;
+    copy->rngstate = rngstate;
+
+    for (auto &r : region)
+        copy->region[r.first] = std::unique_ptr<Region>(new Region(*r.second));
+
+    // Copy the netlist, then point the copies at each other instead of the
+    // originals. Placement and routing are bound again below, through the
+    // Arch API, so that any state the architecture keeps about them is
+    // rebuilt too.
+    for (auto &n : nets) {
+        NetInfo *ni = new NetInfo(*n.second);
+        ni->wires.clear();
+        copy->nets[n.first] = std::unique_ptr<NetInfo>(ni);
+    }
+    for (auto &c : cells) {
+        CellInfo *ci = new CellInfo(*c.second);
+        ci->bel = BelId();
+        ci->belStrength = STRENGTH_NONE;
+        copy->cells[c.first] = std::unique_ptr<CellInfo>(ci);
+    }
+
+    auto copy_cell = [&](const CellInfo *cell) -> CellInfo * {
+        return cell == nullptr ? nullptr : copy->cells.at(cell->name).get();
+    };
+    auto copy_net = [&](const NetInfo *net) -> NetInfo * {
+        return net == nullptr ? nullptr : copy->nets.at(net->name).get();
+    };
+    auto copy_region = [&](const Region *r) -> Region * {
+        return r == nullptr ? nullptr : copy->region.at(r->name).get();
+    };
+
+    for (auto &n : copy->nets) {
+        NetInfo *ni = n.second.get();
+        ni->driver.cell = copy_cell(ni->driver.cell);
+        for (auto &user : ni->users)
+            user.cell = copy_cell(user.cell);
+        ni->region = copy_region(ni->region);
+    }
+    for (auto &c : copy->cells) {
+        CellInfo *ci = c.second.get();
+        for (auto &port : ci->ports)
+            port.second.net = copy_net(port.second.net);
+        ci->constr_parent = copy_cell(ci->constr_parent);
+        for (auto &child : ci->constr_children)
+            child = copy_cell(child);
+        ci->region = copy_region(ci->region);
+    }
+
+    // Architecture specific cell data may point into the original netlist.
+    copy->assignArchInfo();
+
+    for (auto &c : cells)
+        if (c.second->bel != BelId())
+            copy->bindBel(c.second->bel, copy->cells.at(c.first).get(), c.second->belStrength);
+    for (auto &n : nets) {
+        NetInfo *ni = copy->nets.at(n.first).get();
+        for (auto &w : n.second->wires) {
+            if (w.second.pip == PipId())
+                copy->bindWire(w.first, ni, w.second.strength);
+            else
+                copy->bindPip(w.second.pip, ni, w.second.strength);
+        }
+    }
+
+    return copy;
 }
 
 static uint32_t xorshift32(uint32_t x)
@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <atomic>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
@@ -258,6 +259,12 @@ struct PortRef
     CellInfo *cell = nullptr;
     IdString port;
     delay_t budget = 0;
+
+    // Routed delay cache, filled by Context::cacheNetinfoRouteDelays and read
+    // by Context::getNetinfoRouteDelay
+    uint32_t route_gen = 0;
+    WireId route_src, route_dst;
+    delay_t route_delay = 0;
 };
 
 struct PipMap
@@ -278,6 +285,10 @@ struct NetInfo : ArchNetInfo
     // wire -> uphill_pip
     std::unordered_map<WireId, PipMap> wires;
 
+    // Incremented whenever routing is removed from the net, invalidating the
+    // routed delays cached on its users
+    uint32_t route_gen = 1;
+
     Region *region = nullptr;
 };
 
@@ -449,6 +460,7 @@ struct BaseCtx
     void unlock(void)
     {
         NPNR_ASSERT(std::this_thread::get_id() == mutex_owner);
+        publishUi();
         mutex.unlock();
     }
 
@@ -502,18 +514,89 @@ struct BaseCtx
     std::unordered_set<WireId> wireUiReload;
     std::unordered_set<PipId> pipUiReload;
     std::unordered_set<GroupId> groupUiReload;
+    std::vector<std::pair<WireId, int>> congestionUiReload;
 
     void refreshUi() { allUiReload = true; }
 
     void refreshUiFrame() { frameUiReload = true; }
 
-    void refreshUiBel(BelId bel) { belUiReload.insert(bel); }
+    // Changes to single objects are only recorded while the UI wants
+    // snapshots, and never without a GUI, as the arches report every
+    // binding change and the sets would otherwise grow without bound in
+    // headless runs. A full snapshot is sent when the UI attaches.
+    bool uiAttached() const
+    {
+#ifdef NO_GUI
+        return false;
+#else
+        return uiSnapshotEnabled.load(std::memory_order_relaxed);
+#endif
+    }
 
-    void refreshUiWire(WireId wire) { wireUiReload.insert(wire); }
+    void refreshUiBel(BelId bel)
+    {
+        if (uiAttached())
+            belUiReload.insert(bel);
+    }
 
-    void refreshUiPip(PipId pip) { pipUiReload.insert(pip); }
+    void refreshUiWire(WireId wire)
+    {
+        if (uiAttached())
+            wireUiReload.insert(wire);
+    }
 
-    void refreshUiGroup(GroupId group) { groupUiReload.insert(group); }
+    void refreshUiPip(PipId pip)
+    {
+        if (uiAttached())
+            pipUiReload.insert(pip);
+    }
+
+    void refreshUiGroup(GroupId group)
+    {
+        if (uiAttached())
+            groupUiReload.insert(group);
+    }
+
+    // Report the routing congestion score of a wire, for the UI to show.
+    void refreshUiCongestion(WireId wire, int score)
+    {
+        if (uiAttached())
+            congestionUiReload.push_back(std::make_pair(wire, score));
+    }
+
+    // Decals of objects whose UI state changed, published whenever the
+    // processing code unlocks the context or yields, so that the UI can
+    // render them without taking the main lock and stalling it. Only
+    // changes are published; the UI builds the full picture itself.
+    struct UiSnapshot
+    {
+        // Whether the UI must query every object again, as everything may
+        // have changed. The objects in this snapshot changed after that.
+        bool full = false;
+        std::vector<std::pair<BelId, DecalXY>> bels;
+        std::vector<std::pair<WireId, DecalXY>> wires;
+        std::vector<std::pair<PipId, DecalXY>> pips;
+        std::vector<std::pair<GroupId, DecalXY>> groups;
+        // Graphics of the decals above.
+        std::vector<std::pair<DecalId, std::vector<GraphicElement>>> graphics;
+        // Congestion scores of wires that changed, oldest first.
+        std::vector<std::pair<WireId, int>> congestion;
+    };
+
+    // Set by the UI when it wants snapshots published.
+    std::atomic<bool> uiSnapshotEnabled{false};
+    // Lock protecting uiSnapshots, only held to add or take snapshots.
+    std::mutex ui_snapshot_mutex;
+    std::vector<UiSnapshot> uiSnapshots;
+    // Whether a snapshot has been published since uiSnapshotEnabled was set.
+    bool uiSnapshotStarted = false;
+
+    // Publish the pending UI reloads as a snapshot. Must be called with the
+    // main lock taken.
+    void publishUi();
+
+    // Take all snapshots published since the last call, oldest first.
+    std::vector<UiSnapshot> takeUiSnapshots();
 };
 
 NEXTPNR_NAMESPACE_END
@@ -539,6 +622,9 @@ struct Context : Arch, DeterministicRNG
     WireId getNetinfoSourceWire(const NetInfo *net_info) const;
     WireId getNetinfoSinkWire(const NetInfo *net_info, const PortRef &sink) const;
     delay_t getNetinfoRouteDelay(const NetInfo *net_info, const PortRef &sink) const;
+    // Record the routed delay of every fully routed user of the net, for
+    // getNetinfoRouteDelay to return until the net is next ripped up
+    void cacheNetinfoRouteDelays(NetInfo *net_info);
 
     // provided by router1.cc
     bool getActualRouteDelay(WireId src_wire, WireId dst_wire, delay_t *delay = nullptr,
@@ -546,6 +632,12 @@ struct Context : Arch, DeterministicRNG
 
     // --------------------------------------------------------------
 
+    // Make an independent copy of this context: the same device, netlist,
+    // placement, routing and settings, sharing no state with the original.
+    std::unique_ptr<Context> clone() const;
+
+    // --------------------------------------------------------------
+
     uint32_t checksum() const;
 
     void check() const;
@@ -24,8 +24,18 @@
 
 NEXTPNR_NAMESPACE_BEGIN
 
+BelId moved_cell_bel(const CellInfo *cell, const std::vector<MovedCell> *moves)
+{
+    if (moves != nullptr)
+        for (const auto &move : *moves)
+            if (move.cell == cell)
+                return move.bel;
+    return cell->bel;
+}
+
 // Get the total estimated wirelength for a net
-wirelen_t get_net_metric(const Context *ctx, const NetInfo *net, MetricType type, float &tns)
+wirelen_t get_net_metric(const Context *ctx, const NetInfo *net, MetricType type, float &tns,
+                         const std::vector<MovedCell> *moves)
 {
     wirelen_t wirelength = 0;
     Loc driver_loc;
@@ -33,10 +43,11 @@ wirelen_t get_net_metric(const Context *ctx, const NetInfo *net, MetricType type
     CellInfo *driver_cell = net->driver.cell;
     if (!driver_cell)
         return 0;
-    if (driver_cell->bel == BelId())
+    BelId driver_bel = moved_cell_bel(driver_cell, moves);
+    if (driver_bel == BelId())
         return 0;
-    driver_gb = ctx->getBelGlobalBuf(driver_cell->bel);
-    driver_loc = ctx->getBelLocation(driver_cell->bel);
+    driver_gb = ctx->getBelGlobalBuf(driver_bel);
+    driver_loc = ctx->getBelLocation(driver_bel);
     if (driver_gb)
         return 0;
     delay_t negative_slack = 0;
@@ -45,20 +56,20 @@ wirelen_t get_net_metric(const Context *ctx, const NetInfo *net, MetricType type
     for (auto load : net->users) {
         if (load.cell == nullptr)
             continue;
-        CellInfo *load_cell = load.cell;
-        if (load_cell->bel == BelId())
+        BelId load_bel = moved_cell_bel(load.cell, moves);
+        if (load_bel == BelId())
             continue;
         if (ctx->timing_driven && type == MetricType::COST) {
-            delay_t net_delay = ctx->predictDelay(net, load);
+            delay_t net_delay = ctx->predictDelay(driver_bel, net->driver.port, load_bel, load.port);
             auto slack = load.budget - net_delay;
             if (slack < 0)
                 negative_slack += slack;
             worst_slack = std::min(slack, worst_slack);
         }
 
-        if (ctx->getBelGlobalBuf(load_cell->bel))
+        if (ctx->getBelGlobalBuf(load_bel))
             continue;
-        Loc load_loc = ctx->getBelLocation(load_cell->bel);
+        Loc load_loc = ctx->getBelLocation(load_bel);
 
         xmin = std::min(xmin, load_loc.x);
         ymin = std::min(ymin, load_loc.y);
@@ -76,8 +87,9 @@ wirelen_t get_net_metric(const Context *ctx, const NetInfo *net, MetricType type
     return wirelength;
 }
 
-// Get the total wirelength for a cell
-wirelen_t get_cell_metric(const Context *ctx, const CellInfo *cell, MetricType type)
+// Get the total wirelength for a cell, optionally with some cells moved
+static wirelen_t cell_metric(const Context *ctx, const CellInfo *cell, MetricType type,
+                             const std::vector<MovedCell> *moves)
 {
     std::set<IdString> nets;
     for (auto p : cell->ports) {
@@ -87,23 +99,89 @@ wirelen_t get_cell_metric(const Context *ctx, const CellInfo *cell, MetricType t
     wirelen_t wirelength = 0;
     float tns = 0;
     for (auto n : nets) {
-        wirelength += get_net_metric(ctx, ctx->nets.at(n).get(), type, tns);
+        wirelength += get_net_metric(ctx, ctx->nets.at(n).get(), type, tns, moves);
     }
     return wirelength;
 }
 
+wirelen_t get_cell_metric(const Context *ctx, const CellInfo *cell, MetricType type)
+{
+    return cell_metric(ctx, cell, type, nullptr);
+}
+
 wirelen_t get_cell_metric_at_bel(const Context *ctx, CellInfo *cell, BelId bel, MetricType type)
 {
-    BelId oldBel = cell->bel;
-    cell->bel = bel;
-    wirelen_t wirelen = get_cell_metric(ctx, cell, type);
-    cell->bel = oldBel;
-    return wirelen;
+    std::vector<MovedCell> moves{MovedCell{cell, bel}};
+    return cell_metric(ctx, cell, type, &moves);
+}
+
+BelLocationIndex::BelLocationIndex(const Context *ctx)
+{
+    for (auto bel : ctx->getBels()) {
+        Loc loc = ctx->getBelLocation(bel);
+        auto &by_x = bels[ctx->getBelType(bel)];
+        if (int(by_x.size()) < loc.x + 1)
+            by_x.resize(loc.x + 1);
+        if (int(by_x.at(loc.x).size()) < loc.y + 1)
+            by_x.at(loc.x).resize(loc.y + 1);
+        by_x.at(loc.x).at(loc.y).push_back(bel);
+        max_x = std::max(max_x, loc.x);
+        max_y = std::max(max_y, loc.y);
+    }
+}
+
+const std::vector<BelId> *BelLocationIndex::get(IdString type, int x, int y) const
+{
+    auto found = bels.find(type);
+    if (found == bels.end() || x < 0 || x >= int(found->second.size()))
+        return nullptr;
+    auto &by_y = found->second.at(x);
+    if (y < 0 || y >= int(by_y.size()) || by_y.at(y).empty())
+        return nullptr;
+    return &by_y.at(y);
+}
+
+// Rings searched beyond the first one with a free bel, as a bel a little
+// further from the centroid of a cell's connections may still cost less
+static const int ring_search_margin = 3;
+
+// Centroid of the placed cells connected to a cell, ignoring global nets, or
+// the middle of the device if there are none
+static Loc connection_centroid(const Context *ctx, const CellInfo *cell, const BelLocationIndex &index)
+{
+    int64_t sum_x = 0, sum_y = 0, count = 0;
+    auto add = [&](const CellInfo *other) {
+        if (other == nullptr || other == cell || other->bel == BelId())
+            return;
+        Loc loc = ctx->getBelLocation(other->bel);
+        sum_x += loc.x;
+        sum_y += loc.y;
+        count++;
+    };
+    for (auto &port : cell->ports) {
+        const NetInfo *net = port.second.net;
+        if (net == nullptr)
+            continue;
+        const CellInfo *driver = net->driver.cell;
+        if (driver != nullptr && driver->bel != BelId() && ctx->getBelGlobalBuf(driver->bel))
+            continue;
+        add(driver);
+        for (auto &user : net->users)
+            add(user.cell);
+    }
+    if (count == 0)
+        return Loc(index.max_x / 2, index.max_y / 2, 0);
+    return Loc(int(sum_x / count), int(sum_y / count), 0);
 }
 
 // Placing a single cell
-bool place_single_cell(Context *ctx, CellInfo *cell, bool require_legality)
+bool place_single_cell(Context *ctx, CellInfo *cell, bool require_legality, const BelLocationIndex *index)
 {
+    std::unique_ptr<BelLocationIndex> own_index;
+    if (index == nullptr) {
+        own_index = std::unique_ptr<BelLocationIndex>(new BelLocationIndex(ctx));
+        index = own_index.get();
+    }
     bool all_placed = false;
     int iters = 25;
     while (!all_placed) {
@@ -116,8 +194,13 @@ bool place_single_cell(Context *ctx, CellInfo *cell, bool require_legality)
             ctx->unbindBel(cell->bel);
         }
         IdString targetType = cell->type;
-        for (auto bel : ctx->getBels()) {
-            if (ctx->getBelType(bel) == targetType && (!require_legality || ctx->isValidBelForCell(cell, bel))) {
+        auto visit = [&](int x, int y) {
+            const std::vector<BelId> *tile_bels = index->get(targetType, x, y);
+            if (tile_bels == nullptr)
+                return;
+            for (auto bel : *tile_bels) {
+                if (require_legality && !ctx->isValidBelForCell(cell, bel))
+                    continue;
                 if (ctx->checkBelAvail(bel)) {
                     wirelen_t wirelen = get_cell_metric_at_bel(ctx, cell, bel, MetricType::COST);
                     if (iters >= 4)
@@ -140,6 +223,29 @@ bool place_single_cell(Context *ctx, CellInfo *cell, bool require_legality)
                     }
                 }
             }
+        };
+        // Search in square rings around the cell's connections, stopping a
+        // few rings after the first free bel. Ripping up is only considered
+        // when there is no free bel anywhere, so then the whole device is
+        // searched.
+        Loc centre = connection_centroid(ctx, cell, *index);
+        int stop_radius = std::max(std::max(centre.x, index->max_x - centre.x),
+                                   std::max(centre.y, index->max_y - centre.y));
+        for (int r = 0; r <= stop_radius; r++) {
+            if (r == 0) {
+                visit(centre.x, centre.y);
+            } else {
+                for (int x = centre.x - r; x <= centre.x + r; x++) {
+                    visit(x, centre.y - r);
+                    visit(x, centre.y + r);
+                }
+                for (int y = centre.y - r + 1; y <= centre.y + r - 1; y++) {
+                    visit(centre.x - r, y);
+                    visit(centre.x + r, y);
+                }
+            }
+            if (best_bel != BelId())
+                stop_radius = std::min(stop_radius, r + ring_search_margin);
         }
         if (best_bel == BelId()) {
             if (iters == 0) {
@@ -474,8 +580,11 @@ class ConstraintLegaliseWorker
             }
         }
         print_stats("after legalising chains");
+        std::unique_ptr<BelLocationIndex> index;
+        if (!rippedCells.empty())
+            index = std::unique_ptr<BelLocationIndex>(new BelLocationIndex(ctx));
         for (auto rippedCell : rippedCells) {
-            bool res = place_single_cell(ctx, ctx->cells.at(rippedCell).get(), true);
+            bool res = place_single_cell(ctx, ctx->cells.at(rippedCell).get(), true, index.get());
             if (!res) {
                 log_error("failed to place cell '%s' after relative constraint legalisation\n", rippedCell.c_str(ctx));
                 return false;
@@ -493,12 +602,13 @@ class ConstraintLegaliseWorker
 bool legalise_relative_constraints(Context *ctx) { return ConstraintLegaliseWorker(ctx).legalise_constraints(); }
 
 // Get the total distance from satisfied constraints for a cell
-int get_constraints_distance(const Context *ctx, const CellInfo *cell)
+int get_constraints_distance(const Context *ctx, const CellInfo *cell, const std::vector<MovedCell> *moves)
 {
     int dist = 0;
-    if (cell->bel == BelId())
+    BelId bel = moved_cell_bel(cell, moves);
+    if (bel == BelId())
         return 100000;
-    Loc loc = ctx->getBelLocation(cell->bel);
+    Loc loc = ctx->getBelLocation(bel);
     if (cell->constr_parent == nullptr) {
         if (cell->constr_x != cell->UNCONSTR)
             dist += std::abs(cell->constr_x - loc.x);
@@ -507,9 +617,10 @@ int get_constraints_distance(const Context *ctx, const CellInfo *cell)
         if (cell->constr_z != cell->UNCONSTR)
             dist += std::abs(cell->constr_z - loc.z);
     } else {
-        if (cell->constr_parent->bel == BelId())
+        BelId parent_bel = moved_cell_bel(cell->constr_parent, moves);
+        if (parent_bel == BelId())
             return 100000;
-        Loc parent_loc = ctx->getBelLocation(cell->constr_parent->bel);
+        Loc parent_loc = ctx->getBelLocation(parent_bel);
         if (cell->constr_x != cell->UNCONSTR)
             dist += std::abs(cell->constr_x - (loc.x - parent_loc.x));
         if (cell->constr_y != cell->UNCONSTR)
@@ -522,7 +633,7 @@ int get_constraints_distance(const Context *ctx, const CellInfo *cell)
         }
     }
     for (auto child : cell->constr_children)
-        dist += get_constraints_distance(ctx, child);
+        dist += get_constraints_distance(ctx, child, moves);
     return dist;
 }
 
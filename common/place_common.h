@@ -32,8 +32,20 @@ enum class MetricType
     WIRELENGTH
 };
 
-// Return the wirelength of a net
-wirelen_t get_net_metric(const Context *ctx, const NetInfo *net, MetricType type, float &tns);
+// A cell taken to be at a bel other than the one it is bound to, so that the
+// cost of a move can be found without changing CellInfo::bel
+struct MovedCell
+{
+    const CellInfo *cell;
+    BelId bel;
+};
+
+// The bel of a cell, or the one it is moved to if it is in moves
+BelId moved_cell_bel(const CellInfo *cell, const std::vector<MovedCell> *moves);
+
+// Return the wirelength of a net, optionally with some of its cells moved
+wirelen_t get_net_metric(const Context *ctx, const NetInfo *net, MetricType type, float &tns,
+                         const std::vector<MovedCell> *moves = nullptr);
 
 // Return the wirelength of all nets connected to a cell
 wirelen_t get_cell_metric(const Context *ctx, const CellInfo *cell, MetricType type);
@@ -41,14 +53,28 @@ wirelen_t get_cell_metric(const Context *ctx, const CellInfo *cell, MetricType t
 // Return the wirelength of all nets connected to a cell, when the cell is at a given bel
 wirelen_t get_cell_metric_at_bel(const Context *ctx, CellInfo *cell, BelId bel, MetricType type);
 
-// Place a single cell in the lowest wirelength Bel available, optionally requiring validity check
-bool place_single_cell(Context *ctx, CellInfo *cell, bool require_legality);
+// Bels of each type by location, for searching outwards from a point
+struct BelLocationIndex
+{
+    BelLocationIndex(const Context *ctx);
+
+    // Bels of a type at (x, y), or nullptr if there are none
+    const std::vector<BelId> *get(IdString type, int x, int y) const;
+
+    int max_x = 0, max_y = 0;
+    // type -> x -> y -> bels
+    std::unordered_map<IdString, std::vector<std::vector<std::vector<BelId>>>> bels;
+};
+
+// Place a single cell in the lowest wirelength Bel available, optionally requiring validity check. Bels are
+// searched in rings outwards from the cell's connections; an index may be passed to avoid building one per call
+bool place_single_cell(Context *ctx, CellInfo *cell, bool require_legality, const BelLocationIndex *index = nullptr);
 
 // Modify a design s.t. all relative placement constraints are satisfied
 bool legalise_relative_constraints(Context *ctx);
 
-// Get the total distance from satisfied constraints for a cell
-int get_constraints_distance(const Context *ctx, const CellInfo *cell);
+// Get the total distance from satisfied constraints for a cell, optionally with some cells moved
+int get_constraints_distance(const Context *ctx, const CellInfo *cell, const std::vector<MovedCell> *moves = nullptr);
 NEXTPNR_NAMESPACE_END
 
 #endif
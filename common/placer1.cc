@@ -39,6 +39,7 @@
 #include <vector>
 #include "log.h"
 #include "place_common.h"
+#include "telemetry.h"
 #include "timing.h"
 #include "util.h"
 
@@ -92,6 +93,7 @@ class SAPlacer
         log_break();
         ctx->lock();
 
+        std::unique_ptr<TelemetryPhase> phase(new TelemetryPhase("place/initial"));
         size_t placed_cells = 0;
         // Initial constraints placer
         for (auto &cell_entry : ctx->cells) {
@@ -151,11 +153,25 @@ class SAPlacer
         if ((placed_cells - constr_placed_cells) % 500 != 0)
             log_info("  initial placement placed %d/%d cells\n", int(placed_cells - constr_placed_cells),
                      int(autoplaced.size()));
+
+        // Make relative constraints legal now, so that macros can be moved
+        // as a whole from the start and never become illegal
+        legalise_relative_constraints(ctx);
+        unlock_macros();
+        autoplaced.clear();
+        for (auto cell : sorted(ctx->cells)) {
+            if (cell.second->belStrength < STRENGTH_STRONG && cell.second->constr_parent == nullptr)
+                autoplaced.push_back(cell.second);
+        }
+        ctx->shuffle(autoplaced);
+
         if (ctx->slack_redist_iter > 0)
             assign_budget(ctx);
         ctx->yield();
 
         log_info("Running simulated annealing placer.\n");
+        phase.reset(new TelemetryPhase("place/anneal"));
+        int64_t total_moves = 0, total_accepted = 0;
 
         // Calculate metric after initial placement
         curr_metric = 0;
@@ -171,6 +187,21 @@ class SAPlacer
         double avg_metric = curr_metric;
         temp = 10000;
 
+        // With the adaptive schedule, the number of moves per temperature
+        // grows as cells^(4/3), and the anneal ends with a greedy pass once
+        // the temperature is small compared to the average cost of a net.
+        int64_t moves_per_temp = 0;
+        float range_limit = diameter;
+        bool quench = false;
+        if (cfg.adaptiveSchedule) {
+            moves_per_temp = int64_t(cfg.innerNum * std::pow(double(autoplaced.size()), 4.0 / 3.0));
+            if (!autoplaced.empty())
+                moves_per_temp = std::max<int64_t>(moves_per_temp, autoplaced.size());
+            temp = initial_temperature(autoplaced);
+            telemetry_gauge("place/initial_temp", temp);
+            min_metric = curr_metric;
+        }
+
         // Main simulated annealing loop
         for (int iter = 1;; iter++) {
             n_move = n_accept = 0;
@@ -181,18 +212,23 @@ class SAPlacer
                          "%.0f, est tns = %.02fns\n",
                          iter, temp, double(curr_metric), curr_tns);
 
-            for (int m = 0; m < 15; ++m) {
-                // Loop through all automatically placed cells
-                for (auto cell : autoplaced) {
-                    // Find another random Bel for this cell
-                    BelId try_bel = random_bel_for_cell(cell);
-                    // If valid, try and swap to a new position and see if
-                    // the new position is valid/worthwhile
-                    if (try_bel != BelId() && try_bel != cell->bel)
-                        try_swap_position(cell, try_bel);
+            if (cfg.adaptiveSchedule) {
+                for (int64_t m = 0; m < moves_per_temp; m++)
+                    try_random_move(autoplaced.at(m % autoplaced.size()));
+            } else {
+                for (int m = 0; m < 15; ++m) {
+                    // Loop through all automatically placed cells
+                    for (auto cell : autoplaced)
+                        try_random_move(cell);
                 }
             }
 
+            total_moves += n_move;
+            total_accepted += n_accept;
+            telemetry_count("place/iterations");
+            if (n_move > 0)
+                telemetry_sample("place/accept_ratio", double(n_accept) / double(n_move));
+
             if (curr_metric < min_metric) {
                 min_metric = curr_metric;
                 improved = true;
@@ -204,19 +240,46 @@ class SAPlacer
             else
                 n_no_progress++;
 
-            if (temp <= 1e-3 && n_no_progress >= 5) {
-                if (iter % 5 != 0)
-                    log_info("  at iteration #%d: temp = %f, cost = %f\n", iter, temp, double(curr_metric));
-                break;
-            }
-
-            double Raccept = double(n_accept) / double(n_move);
+            double Raccept = n_move > 0 ? double(n_accept) / double(n_move) : 0;
 
             int M = std::max(max_x, max_y) + 1;
 
             double upper = 0.6, lower = 0.4;
 
-            if (curr_metric < 0.95 * avg_metric) {
+            if (cfg.adaptiveSchedule) {
+                if (quench) {
+                    if (iter % 5 != 0)
+                        log_info("  at iteration #%d: temp = %f, cost = %f\n", iter, temp, double(curr_metric));
+                    break;
+                }
+                // Cool slowly while moves are neither nearly all accepted nor
+                // nearly all rejected. As in VPR, a low acceptance rate only
+                // speeds up cooling once the range of moves can shrink no
+                // further, as until then shrinking it raises the rate.
+                if (Raccept > 0.96)
+                    temp *= 0.5;
+                else if (Raccept > 0.8)
+                    temp *= 0.9;
+                else if (Raccept > 0.15 || range_limit > 1)
+                    temp *= 0.95;
+                else
+                    temp *= 0.8;
+                // Scale the range of moves so that the acceptance rate heads
+                // towards the 44% that keeps the anneal most productive
+                range_limit *= 1 - target_accept_rate + Raccept;
+                range_limit = std::max(1.0f, std::min(float(M), range_limit));
+                diameter = int(range_limit + 0.5);
+                if (curr_metric == 0 ||
+                    temp < exit_temp_factor * double(curr_metric) / std::max<size_t>(1, ctx->nets.size())) {
+                    // Finish with a pass accepting only moves that improve the cost
+                    quench = true;
+                    temp = 1e-7;
+                }
+            } else if (temp <= 1e-3 && n_no_progress >= 5) {
+                if (iter % 5 != 0)
+                    log_info("  at iteration #%d: temp = %f, cost = %f\n", iter, temp, double(curr_metric));
+                break;
+            } else if (curr_metric < 0.95 * avg_metric) {
                 avg_metric = 0.8 * avg_metric + 0.2 * curr_metric;
             } else {
                 if (Raccept >= 0.8) {
@@ -236,26 +299,8 @@ class SAPlacer
                         temp *= 0.8;
                 }
             }
-            // Once cooled below legalise threshold, run legalisation and start requiring
-            // legal moves only
-            if (temp < legalise_temp && !require_legal) {
-                legalise_relative_constraints(ctx);
-                require_legal = true;
-                autoplaced.clear();
-                for (auto cell : sorted(ctx->cells)) {
-                    if (cell.second->belStrength < STRENGTH_STRONG)
-                        autoplaced.push_back(cell.second);
-                }
-                temp = post_legalise_temp;
-                diameter *= post_legalise_dia_scale;
-                ctx->shuffle(autoplaced);
-
-                // Legalisation is a big change so force a slack redistribution here
-                if (ctx->slack_redist_iter > 0)
-                    assign_budget(ctx, true /* quiet */);
-            } else if (ctx->slack_redist_iter > 0 && iter % ctx->slack_redist_iter == 0) {
+            if (ctx->slack_redist_iter > 0 && iter % ctx->slack_redist_iter == 0)
                 assign_budget(ctx, true /* quiet */);
-            }
 
             // Recalculate total metric entirely to avoid rounding errors
             // accumulating over time
@@ -270,6 +315,14 @@ class SAPlacer
             // Let the UI show visualization updates.
             ctx->yield();
         }
+        telemetry_count("place/moves", total_moves);
+        telemetry_count("place/accepted", total_accepted);
+        if (total_moves > 0) {
+            telemetry_gauge("place/moves_per_sec", total_moves / std::max(phase->elapsed(), 1e-9));
+            telemetry_gauge("place/accept_ratio", double(total_accepted) / double(total_moves));
+        }
+        phase.reset();
+
         // Final post-pacement validitiy check
         ctx->yield();
         for (auto bel : ctx->getBels()) {
@@ -293,6 +346,11 @@ class SAPlacer
             if (get_constraints_distance(ctx, cell.second) != 0)
                 log_error("constraint satisfaction check failed for cell '%s' at Bel '%s'\n", cell.first.c_str(ctx),
                           ctx->getBelName(cell.second->bel).c_str(ctx));
+        wirelen_t wirelength = 0;
+        float tns = 0;
+        for (auto &net : ctx->nets)
+            wirelength += get_net_metric(ctx, net.second.get(), MetricType::WIRELENGTH, tns);
+        telemetry_gauge("place/wirelength", wirelength);
         timing_analysis(ctx);
         ctx->unlock();
         return true;
@@ -349,26 +407,84 @@ class SAPlacer
         }
     }
 
-    // Attempt a SA position swap, return true on success or false on failure
-    bool try_swap_position(CellInfo *cell, BelId newBel)
+    // Try moving a cell, and the macro it is the root of if any, to a random
+    // bel within the current diameter
+    void try_random_move(CellInfo *cell)
     {
-        static std::vector<NetInfo *> updates;
-        updates.clear();
-        BelId oldBel = cell->bel;
-        CellInfo *other_cell = ctx->getBoundBelCell(newBel);
-        if (other_cell != nullptr && other_cell->belStrength > STRENGTH_WEAK) {
-            return false;
+        BelId try_bel = random_bel_for_cell(cell);
+        // If valid, try and swap to a new position and see if
+        // the new position is valid/worthwhile
+        if (try_bel == BelId() || try_bel == cell->bel)
+            return;
+        if (is_macro(cell))
+            try_move_macro(cell, try_bel);
+        else
+            try_swap_position(cell, try_bel);
+    }
+
+    // Pick a starting temperature for the adaptive schedule, as a multiple of
+    // the standard deviation of the cost over a sequence of random moves that
+    // are all accepted.
+    float initial_temperature(const std::vector<CellInfo *> &cells)
+    {
+        if (cells.empty())
+            return 0;
+        temp = std::numeric_limits<float>::max();
+        wirelen_t start_metric = curr_metric;
+        double sum = 0, sum_sq = 0;
+        for (auto cell : cells) {
+            try_random_move(cell);
+            double x = double(curr_metric - start_metric);
+            sum += x;
+            sum_sq += x * x;
         }
-        int old_dist = get_constraints_distance(ctx, cell);
-        int new_dist;
-        if (other_cell != nullptr)
-            old_dist += get_constraints_distance(ctx, other_cell);
-        wirelen_t new_metric = 0, delta;
-        ctx->unbindBel(oldBel);
-        if (other_cell != nullptr) {
-            ctx->unbindBel(newBel);
+        double mean = sum / cells.size();
+        double var = std::max(0.0, sum_sq / cells.size() - mean * mean);
+        return float(initial_temp_factor * std::sqrt(var));
+    }
+
+    // Whether a cell is part of a macro of cells with relative placement
+    // constraints, which is only ever moved as a whole
+    static bool is_macro(const CellInfo *cell)
+    {
+        return cell->constr_parent != nullptr || !cell->constr_children.empty();
+    }
+
+    static void get_macro_cells(CellInfo *cell, std::vector<CellInfo *> &cells)
+    {
+        cells.push_back(cell);
+        for (auto child : cell->constr_children)
+            get_macro_cells(child, cells);
+    }
+
+    // Legalisation locks down every macro. Unlock those that can be moved
+    // by translating them, which keeps them legal: those without absolute x
+    // or y constraints on their root, and with no cells placed by the user.
+    void unlock_macros()
+    {
+        std::vector<CellInfo *> macro_cells;
+        for (auto &cell : ctx->cells) {
+            CellInfo *root = cell.second.get();
+            if (root->constr_parent != nullptr || root->constr_children.empty())
+                continue;
+            if (root->constr_x != root->UNCONSTR || root->constr_y != root->UNCONSTR)
+                continue;
+            macro_cells.clear();
+            get_macro_cells(root, macro_cells);
+            bool user_placed = false;
+            for (auto mc : macro_cells)
+                if (locked_bels.count(mc->bel))
+                    user_placed = true;
+            if (user_placed)
+                continue;
+            for (auto mc : macro_cells)
+                mc->belStrength = STRENGTH_WEAK;
         }
+    }
 
+    // Mark the nets of a cell being moved as needing their cost updated
+    void add_move_cell_nets(const CellInfo *cell)
+    {
         for (const auto &port : cell->ports) {
             if (port.second.net != nullptr) {
                 auto &cost = costs[port.second.net->udata];
@@ -378,69 +494,187 @@ class SAPlacer
                 updates.emplace_back(port.second.net);
             }
         }
+    }
 
-        if (other_cell != nullptr) {
-            for (const auto &port : other_cell->ports)
-                if (port.second.net != nullptr) {
-                    auto &cost = costs[port.second.net->udata];
-                    if (cost.new_cost == 0)
-                        continue;
-                    cost.new_cost = 0;
-                    updates.emplace_back(port.second.net);
-                }
+    // Attempt to move a macro by translating its root to the location of
+    // newBel, keeping the z of each cell. Cells in the way are moved into the
+    // bels the macro leaves. Return true if the move was accepted.
+    bool try_move_macro(CellInfo *root, BelId newBel)
+    {
+        updates.clear();
+        macro_cells.clear();
+        macro_moves.clear();
+        Loc root_loc = ctx->getBelLocation(root->bel), new_root_loc = ctx->getBelLocation(newBel);
+        int dx = new_root_loc.x - root_loc.x, dy = new_root_loc.y - root_loc.y;
+        if (dx == 0 && dy == 0)
+            return false;
+
+        get_macro_cells(root, macro_cells);
+        std::vector<CellInfo *> displaced;
+        for (auto cell : macro_cells) {
+            Loc loc = ctx->getBelLocation(cell->bel);
+            loc.x += dx;
+            loc.y += dy;
+            BelId bel = ctx->getBelByLocation(loc);
+            if (bel == BelId() || ctx->getBelType(bel) != cell->type || locked_bels.count(bel))
+                return false;
+            CellInfo *occupant = ctx->getBoundBelCell(bel);
+            if (occupant != nullptr &&
+                std::find(macro_cells.begin(), macro_cells.end(), occupant) == macro_cells.end()) {
+                if (occupant->belStrength > STRENGTH_WEAK || is_macro(occupant))
+                    return false;
+                displaced.push_back(occupant);
+            }
+            macro_moves.push_back(CellMove{cell, cell->bel, bel});
         }
 
-        ctx->bindBel(newBel, cell, STRENGTH_WEAK);
+        // Give each displaced cell a bel of its type that the macro leaves
+        size_t n_macro_moves = macro_moves.size();
+        for (auto cell : displaced) {
+            BelId vacated = BelId();
+            for (size_t i = 0; i < n_macro_moves && vacated == BelId(); i++) {
+                BelId bel = macro_moves.at(i).old_bel;
+                if (ctx->getBelType(bel) != cell->type)
+                    continue;
+                bool taken = false;
+                for (auto &move : macro_moves)
+                    if (move.new_bel == bel)
+                        taken = true;
+                if (!taken)
+                    vacated = bel;
+            }
+            if (vacated == BelId())
+                return false;
+            macro_moves.push_back(CellMove{cell, cell->bel, vacated});
+        }
 
-        if (other_cell != nullptr) {
-            ctx->bindBel(oldBel, other_cell, STRENGTH_WEAK);
+        // Macro moves are rare, and involve too many cells to check their
+        // legality speculatively, so bind the cells in their new places to
+        // check it. Invalid moves are undone before they count as moves or
+        // draw from the RNG.
+        for (auto &move : macro_moves)
+            ctx->unbindBel(move.old_bel);
+        for (auto &move : macro_moves)
+            ctx->bindBel(move.new_bel, move.cell, STRENGTH_WEAK);
+        for (auto &move : macro_moves) {
+            if (!ctx->isBelLocationValid(move.new_bel)) {
+                undo_macro_moves();
+                return false;
+            }
         }
-        if (!ctx->isBelLocationValid(newBel) || ((other_cell != nullptr && !ctx->isBelLocationValid(oldBel)))) {
-            ctx->unbindBel(newBel);
-            if (other_cell != nullptr)
-                ctx->unbindBel(oldBel);
-            goto swap_fail;
+
+        for (auto &move : macro_moves)
+            add_move_cell_nets(move.cell);
+        wirelen_t new_metric = update_costs(), delta;
+
+        delta = new_metric - curr_metric;
+        n_move++;
+        // SA acceptance criterea
+        if (delta >= 0 && !(temp > 1e-6 && (ctx->rng() / float(0x3fffffff)) <= std::exp(-delta / temp))) {
+            undo_macro_moves();
+            goto move_fail;
         }
 
-        new_metric = curr_metric;
+        n_accept++;
+        commit_costs(new_metric);
+        return true;
+    move_fail:
+        for (const auto &net : updates)
+            costs[net->udata].new_cost = -1;
+        return false;
+    }
 
-        // Recalculate metrics for all nets touched by the peturbation
+    // Put the cells of macro_moves back at their old bels
+    void undo_macro_moves()
+    {
+        for (auto &move : macro_moves)
+            ctx->unbindBel(move.new_bel);
+        for (auto &move : macro_moves)
+            ctx->bindBel(move.old_bel, move.cell, STRENGTH_WEAK);
+    }
+
+    // Recalculate the cost of the nets touched by a move, with the cells in
+    // moves at their new bels, returning the new total cost
+    wirelen_t update_costs(const std::vector<MovedCell> *moves = nullptr)
+    {
+        wirelen_t new_metric = curr_metric;
         for (const auto &net : updates) {
             auto &c = costs[net->udata];
             new_metric -= c.curr_cost;
             float temp_tns = 0;
-            wirelen_t net_new_wl = get_net_metric(ctx, net, MetricType::COST, temp_tns);
+            wirelen_t net_new_wl = get_net_metric(ctx, net, MetricType::COST, temp_tns, moves);
             new_metric += net_new_wl;
             c.new_cost = net_new_wl;
         }
+        return new_metric;
+    }
+
+    void commit_costs(wirelen_t new_metric)
+    {
+        curr_metric = new_metric;
+        for (const auto &net : updates) {
+            auto &c = costs[net->udata];
+            c = CostChange{c.new_cost, -1};
+        }
+    }
 
-        new_dist = get_constraints_distance(ctx, cell);
+    // Attempt a SA position swap, return true on success or false on failure.
+    // The swap is checked and its cost found with the cells only taken to be
+    // at their new bels, and the Arch bindings are only updated once it has
+    // been accepted. This saves binding and unbinding twice for the majority
+    // of moves that are rejected.
+    bool try_swap_position(CellInfo *cell, BelId newBel)
+    {
+        updates.clear();
+        BelId oldBel = cell->bel;
+        CellInfo *other_cell = ctx->getBoundBelCell(newBel);
+        if (other_cell != nullptr && (other_cell->belStrength > STRENGTH_WEAK || is_macro(other_cell))) {
+            return false;
+        }
+        // Invalid swaps are rejected before they count as moves or draw from
+        // the RNG
+        if (!ctx->isValidBelForCell(cell, newBel, other_cell) ||
+            (other_cell != nullptr && !ctx->isValidBelForCell(other_cell, oldBel, cell)))
+            return false;
+
+        int old_dist = get_constraints_distance(ctx, cell);
+        int new_dist;
+        if (other_cell != nullptr)
+            old_dist += get_constraints_distance(ctx, other_cell);
+        wirelen_t new_metric, delta;
+
+        add_move_cell_nets(cell);
+        if (other_cell != nullptr)
+            add_move_cell_nets(other_cell);
+
+        // Recalculate metrics for all nets touched by the peturbation
+        moved_cells.clear();
+        moved_cells.push_back(MovedCell{cell, newBel});
         if (other_cell != nullptr)
-            new_dist += get_constraints_distance(ctx, other_cell);
+            moved_cells.push_back(MovedCell{other_cell, oldBel});
+        new_metric = update_costs(&moved_cells);
+        new_dist = get_constraints_distance(ctx, cell, &moved_cells);
+        if (other_cell != nullptr)
+            new_dist += get_constraints_distance(ctx, other_cell, &moved_cells);
+
         delta = new_metric - curr_metric;
         delta += (cfg.constraintWeight / temp) * (new_dist - old_dist);
         n_move++;
         // SA acceptance criterea
-        if (delta < 0 || (temp > 1e-6 && (ctx->rng() / float(0x3fffffff)) <= std::exp(-delta / temp))) {
-            n_accept++;
-        } else {
-            if (other_cell != nullptr)
-                ctx->unbindBel(oldBel);
-            ctx->unbindBel(newBel);
+        if (delta >= 0 && !(temp > 1e-6 && (ctx->rng() / float(0x3fffffff)) <= std::exp(-delta / temp)))
             goto swap_fail;
-        }
-        curr_metric = new_metric;
-        for (const auto &net : updates) {
-            auto &c = costs[net->udata];
-            c = CostChange{c.new_cost, -1};
-        }
 
+        ctx->unbindBel(oldBel);
+        if (other_cell != nullptr)
+            ctx->unbindBel(newBel);
+        ctx->bindBel(newBel, cell, STRENGTH_WEAK);
+        if (other_cell != nullptr)
+            ctx->bindBel(oldBel, other_cell, STRENGTH_WEAK);
+
+        n_accept++;
+        commit_costs(new_metric);
         return true;
     swap_fail:
-        ctx->bindBel(oldBel, cell, STRENGTH_WEAK);
-        if (other_cell != nullptr) {
-            ctx->bindBel(newBel, other_cell, STRENGTH_WEAK);
-        }
         for (const auto &net : updates)
             costs[net->udata].new_cost = -1;
         return false;
@@ -477,13 +711,12 @@ class SAPlacer
     bool improved = false;
     int n_move, n_accept;
     int diameter = 35, max_x = 1, max_y = 1;
+    const double target_accept_rate = 0.44;
+    const double initial_temp_factor = 20;
+    const double exit_temp_factor = 0.005;
     std::unordered_map<IdString, int> bel_types;
     std::vector<std::vector<std::vector<std::vector<BelId>>>> fast_bels;
     std::unordered_set<BelId> locked_bels;
-    bool require_legal = false;
-    const float legalise_temp = 1;
-    const float post_legalise_temp = 10;
-    const float post_legalise_dia_scale = 1.5;
     Placer1Cfg cfg;
 
     struct CostChange
@@ -493,9 +726,27 @@ class SAPlacer
     };
     std::vector<CostChange> costs;
     std::vector<decltype(NetInfo::udata)> old_udata;
+    // Nets whose cost the move being tried is updating
+    std::vector<NetInfo *> updates;
+
+    struct CellMove
+    {
+        CellInfo *cell;
+        BelId old_bel, new_bel;
+    };
+    // Scratch space for try_move_macro
+    std::vector<CellInfo *> macro_cells;
+    std::vector<CellMove> macro_moves;
+    // Scratch space for try_swap_position
+    std::vector<MovedCell> moved_cells;
 };
 
-Placer1Cfg::Placer1Cfg(Context *ctx) : Settings(ctx) { constraintWeight = get<float>("placer1/constraintWeight", 10); }
+Placer1Cfg::Placer1Cfg(Context *ctx) : Settings(ctx)
+{
+    constraintWeight = get<float>("placer1/constraintWeight", 10);
+    adaptiveSchedule = get<bool>("placer1/adaptiveSchedule", false);
+    innerNum = get<float>("placer1/innerNum", 1);
+}
 
 bool placer1(Context *ctx, Placer1Cfg cfg)
 {
@@ -28,6 +28,12 @@ struct Placer1Cfg : public Settings
 {
     Placer1Cfg(Context *ctx);
     float constraintWeight;
+    // Use an adaptive annealing schedule, where the starting temperature,
+    // cooling rate and move range follow the cost and acceptance rate
+    bool adaptiveSchedule;
+    // Moves per temperature with the adaptive schedule, as a multiple of
+    // cells^(4/3)
+    float innerNum;
 };
 
 extern bool placer1(Context *ctx, Placer1Cfg cfg);
@@ -62,6 +62,8 @@ Context *load_design_shim(std::string filename, ArchArgs args)
     return d;
 }
 
+Context *clone_context_shim(const Context &ctx) { return ctx.clone().release(); }
+
 void translate_assertfail(const assertion_failure &e)
 {
     // Use the Python 'C' API to set up an exception object
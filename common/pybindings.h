@@ -62,6 +62,9 @@ void deinit_python();
 
 void execute_python_file(const char *python_file);
 
+// Clone a context, for Python to own the copy
+Context *clone_context_shim(const Context &ctx);
+
 // Defauld IdString conversions
 namespace PythonConversion {
 
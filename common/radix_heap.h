@@ -0,0 +1,122 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef RADIX_HEAP_H
+#define RADIX_HEAP_H
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// A monotone priority queue of values with unsigned integer keys, popping a
+// value with the smallest key first, as used by Dijkstra and A* searches.
+// Values are kept in buckets by the highest bit in which their key differs
+// from the last key popped, making push O(1) and pop O(log C) amortised,
+// where C is the largest difference between keys.
+//
+// Keys must never be smaller than the last key popped; smaller keys are
+// raised to it, which for a search with an inconsistent heuristic just
+// expands such values next. Values with equal keys are popped in no
+// particular order.
+template <typename T> class RadixHeap
+{
+  public:
+    bool empty() const { return count == 0; }
+
+    size_t size() const { return count; }
+
+    void clear()
+    {
+        for (auto &bucket : buckets)
+            bucket.clear();
+        last = 0;
+        count = 0;
+    }
+
+    void push(uint64_t key, const T &value)
+    {
+        if (key < last)
+            key = last;
+        buckets[bucket_of(key)].emplace_back(key, value);
+        count++;
+    }
+
+    // Key of the value pop() returns next. The heap must not be empty.
+    uint64_t top_key()
+    {
+        refill();
+        return last;
+    }
+
+    // Remove and return a value with the smallest key. The heap must not be
+    // empty.
+    T pop()
+    {
+        refill();
+        T value = std::move(buckets[0].back().second);
+        buckets[0].pop_back();
+        count--;
+        return value;
+    }
+
+  private:
+    static int highest_bit(uint64_t x)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(x);
+#else
+        int bit = 0;
+        while (x >>= 1)
+            bit++;
+        return bit;
+#endif
+    }
+
+    int bucket_of(uint64_t key) const { return key == last ? 0 : highest_bit(key ^ last) + 1; }
+
+    // Make sure bucket 0, which holds the values whose key is last, is not
+    // empty, by moving last up to the smallest key in the first non-empty
+    // bucket and spreading that bucket over the ones below it.
+    void refill()
+    {
+        NPNR_ASSERT(count > 0);
+        if (!buckets[0].empty())
+            return;
+        int i = 1;
+        while (buckets[i].empty())
+            i++;
+        uint64_t smallest = buckets[i].front().first;
+        for (auto &entry : buckets[i])
+            if (entry.first < smallest)
+                smallest = entry.first;
+        last = smallest;
+        for (auto &entry : buckets[i])
+            buckets[bucket_of(entry.first)].push_back(std::move(entry));
+        buckets[i].clear();
+    }
+
+    std::vector<std::pair<uint64_t, T>> buckets[65];
+    uint64_t last = 0;
+    size_t count = 0;
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif
@@ -17,11 +17,18 @@
  *
  */
 
+#include <atomic>
 #include <cmath>
+#include <exception>
+#include <memory>
 #include <queue>
+#include <thread>
+#include <type_traits>
 
 #include "log.h"
+#include "radix_heap.h"
 #include "router1.h"
+#include "telemetry.h"
 #include "timing.h"
 
 namespace {
@@ -54,16 +61,6 @@ struct QueuedWire
     PipId pip;
 
     delay_t delay = 0, togo = 0;
-    int randtag = 0;
-
-    struct Greater
-    {
-        bool operator()(const QueuedWire &lhs, const QueuedWire &rhs) const noexcept
-        {
-            delay_t l = lhs.delay + lhs.togo, r = rhs.delay + rhs.togo;
-            return l == r ? lhs.randtag > rhs.randtag : l > r;
-        }
-    };
 };
 
 struct RipupScoreboard
@@ -72,8 +69,75 @@ struct RipupScoreboard
     std::unordered_map<PipId, int> pipScores;
     std::unordered_map<std::pair<IdString, WireId>, int, hash_id_wire> netWireScores;
     std::unordered_map<std::pair<IdString, PipId>, int, hash_id_pip> netPipScores;
+    // Wires whose score changed since the last sample.
+    std::unordered_set<WireId> changedWires;
+    // Arcs routed, and how many of them per net could not be routed within
+    // the bounding box of their net.
+    int arcCnt = 0;
+    std::unordered_map<IdString, int> netWidenCnt;
+
+    void countArcs(IdString net_name, int arcs, int widened)
+    {
+        arcCnt += arcs;
+        if (widened > 0)
+            netWidenCnt[net_name] += widened;
+    }
+
+    // Report the scores of the wires that changed since the last call to
+    // the UI, which shows them as routing congestion.
+    void sampleUi(Context *ctx)
+    {
+        for (auto wire : changedWires)
+            ctx->refreshUiCongestion(wire, wireScores.at(wire));
+        changedWires.clear();
+    }
+};
+
+// Region of the device, in tiles, inclusive
+struct BoundingBox
+{
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+
+    bool overlaps(const BoundingBox &other) const
+    {
+        return x0 <= other.x1 && other.x0 <= x1 && y0 <= other.y1 && other.y0 <= y1;
+    }
 };
 
+// Bounding box of the placed driver and users of a net, grown by the margin
+// of cfg, which searches for the net's arcs are confined to. Returns false
+// if searches are not to be confined.
+bool getNetBoundingBox(Context *ctx, const Router1Cfg &cfg, const NetInfo *net_info, BoundingBox &bb)
+{
+    if (cfg.bbMargin < 0)
+        return false;
+    bool first = true;
+    auto add_cell = [&](const CellInfo *cell) {
+        if (cell == nullptr || cell->bel == BelId())
+            return;
+        Loc loc = ctx->getBelLocation(cell->bel);
+        if (first || loc.x < bb.x0)
+            bb.x0 = loc.x;
+        if (first || loc.y < bb.y0)
+            bb.y0 = loc.y;
+        if (first || loc.x > bb.x1)
+            bb.x1 = loc.x;
+        if (first || loc.y > bb.y1)
+            bb.y1 = loc.y;
+        first = false;
+    };
+    add_cell(net_info->driver.cell);
+    for (auto &user : net_info->users)
+        add_cell(user.cell);
+    if (first)
+        return false;
+    bb.x0 -= cfg.bbMargin;
+    bb.y0 -= cfg.bbMargin;
+    bb.x1 += cfg.bbMargin;
+    bb.y1 += cfg.bbMargin;
+    return true;
+}
+
 void ripup_net(Context *ctx, IdString net_name)
 {
     if (ctx->debug)
@@ -106,7 +170,7 @@ struct Router
 {
     Context *ctx;
     const Router1Cfg &cfg;
-    RipupScoreboard scores;
+    RipupScoreboard &scores;
     IdString net_name;
 
     bool ripup;
@@ -114,15 +178,45 @@ struct Router
 
     std::unordered_set<IdString> rippedNets;
     std::unordered_map<WireId, QueuedWire> visited;
+    RadixHeap<QueuedWire> queue;
     int visitCnt = 0, revisitCnt = 0, overtimeRevisitCnt = 0;
     bool routedOkay = false;
     delay_t maxDelay = 0.0;
     WireId failedDest;
 
-    void route(const std::unordered_map<WireId, delay_t> &src_wires, WireId dst_wire)
+    // Arcs searched, and how many of them needed the search widened beyond
+    // the bounding box
+    int arcCnt = 0, widenCnt = 0;
+
+    // Region the search is confined to, if bbLimited
+    bool bbLimited = false;
+    BoundingBox bb;
+
+    // A search only router leaves the bindings of the Arch alone, so that
+    // many can run in parallel, and keeps the routing it found for commit()
+    bool searchOnly = false;
+    WireId searchedSrc;
+    std::vector<PipId> searchedPips;
+
+    // Random tiebreak between wires of equal cost, drawn from a generator of
+    // the router's own so that searches on other threads draw the same
+    DeterministicRNG tiebreak;
+
+    // Priority of a wire in the queue, which needs unsigned integer keys: the
+    // cost in the high bits, and a random tiebreak in the low ones
+    uint64_t queueKey(const QueuedWire &qw)
     {
-        std::priority_queue<QueuedWire, std::vector<QueuedWire>, QueuedWire::Greater> queue;
+        const uint64_t max_cost = (uint64_t(1) << 34) - 1;
+        delay_t key = qw.delay + qw.togo;
+        uint64_t cost = 0;
+        if (key > 0)
+            cost = std::is_integral<delay_t>::value ? uint64_t(key) : uint64_t(key / ctx->getDelayEpsilon());
+        return (std::min(cost, max_cost) << 30) | uint64_t(tiebreak.rng());
+    }
 
+    void route(const std::unordered_map<WireId, delay_t> &src_wires, WireId dst_wire)
+    {
+        queue.clear();
         visited.clear();
 
         for (auto &it : src_wires) {
@@ -132,9 +226,8 @@ struct Router
             qw.delay = it.second - (it.second / 16);
             if (cfg.useEstimate)
                 qw.togo = ctx->estimateDelay(qw.wire, dst_wire);
-            qw.randtag = ctx->rng();
 
-            queue.push(qw);
+            queue.push(queueKey(qw), qw);
             visited[qw.wire] = qw;
         }
 
@@ -142,13 +235,17 @@ struct Router
         int thisVisitCntLimit = 0;
 
         while (!queue.empty() && (thisVisitCntLimit == 0 || thisVisitCnt < thisVisitCntLimit)) {
-            QueuedWire qw = queue.top();
-            queue.pop();
+            QueuedWire qw = queue.pop();
 
             if (thisVisitCntLimit == 0 && visited.count(dst_wire))
                 thisVisitCntLimit = (thisVisitCnt * 3) / 2;
 
             for (auto pip : ctx->getPipsDownhill(qw.wire)) {
+                if (bbLimited) {
+                    Loc loc = ctx->getPipLocation(pip);
+                    if (loc.x < bb.x0 || loc.x > bb.x1 || loc.y < bb.y0 || loc.y > bb.y1)
+                        continue;
+                }
                 delay_t next_delay = qw.delay + ctx->getPipDelay(pip).maxDelay();
                 WireId next_wire = ctx->getPipDstWire(pip);
                 bool foundRipupNet = false;
@@ -219,10 +316,9 @@ struct Router
                 next_qw.delay = next_delay;
                 if (cfg.useEstimate)
                     next_qw.togo = ctx->estimateDelay(next_wire, dst_wire);
-                next_qw.randtag = ctx->rng();
 
                 visited[next_qw.wire] = next_qw;
-                queue.push(next_qw);
+                queue.push(queueKey(next_qw), next_qw);
             }
         }
 
@@ -230,9 +326,10 @@ struct Router
     }
 
     Router(Context *ctx, const Router1Cfg &cfg, RipupScoreboard &scores, WireId src_wire, WireId dst_wire,
-           bool ripup = false, delay_t ripup_penalty = 0)
+           uint64_t seed, bool ripup = false, delay_t ripup_penalty = 0)
             : ctx(ctx), cfg(cfg), scores(scores), ripup(ripup), ripup_penalty(ripup_penalty)
     {
+        tiebreak.rngseed(seed);
         std::unordered_map<WireId, delay_t> src_wires;
         src_wires[src_wire] = ctx->getWireDelay(src_wire).maxDelay();
         route(src_wires, dst_wire);
@@ -254,10 +351,15 @@ struct Router
         }
     }
 
-    Router(Context *ctx, const Router1Cfg &cfg, RipupScoreboard &scores, IdString net_name, int user_idx = -1,
-           bool reroute = false, bool ripup = false, delay_t ripup_penalty = 0)
-            : ctx(ctx), cfg(cfg), scores(scores), net_name(net_name), ripup(ripup), ripup_penalty(ripup_penalty)
+    Router(Context *ctx, const Router1Cfg &cfg, RipupScoreboard &scores, IdString net_name, int user_idx,
+           uint64_t seed, bool reroute = false, bool ripup = false, delay_t ripup_penalty = 0, bool searchOnly = false)
+            : ctx(ctx), cfg(cfg), scores(scores), net_name(net_name), ripup(ripup), ripup_penalty(ripup_penalty),
+              searchOnly(searchOnly)
     {
+        tiebreak.rngseed(seed);
+        // Searching only is for routing without ripup within the bounding box
+        NPNR_ASSERT(!searchOnly || (!reroute && !ripup));
+
         auto net_info = ctx->nets.at(net_name).get();
 
         if (ctx->debug)
@@ -277,13 +379,19 @@ struct Router
 
         std::unordered_map<WireId, delay_t> src_wires;
         std::vector<std::pair<delay_t, int>> users_array;
+        bbLimited = getNetBoundingBox(ctx, cfg, net_info, bb);
+        if (searchOnly && !bbLimited)
+            return;
 
         if (user_idx < 0) {
-            // route all users, from worst to best slack
+            // route all users, from worst to best slack, or nearest first when
+            // building a tree so that later users can branch off the routing
+            // of earlier ones
             for (int user_idx = 0; user_idx < int(net_info->users.size()); user_idx++) {
                 auto dst_wire = ctx->getNetinfoSinkWire(net_info, net_info->users[user_idx]);
-                delay_t slack = net_info->users[user_idx].budget - ctx->estimateDelay(src_wire, dst_wire);
-                users_array.push_back(std::pair<delay_t, int>(slack, user_idx));
+                delay_t estimate = ctx->estimateDelay(src_wire, dst_wire);
+                delay_t key = cfg.netTree ? estimate : net_info->users[user_idx].budget - estimate;
+                users_array.push_back(std::pair<delay_t, int>(key, user_idx));
             }
             std::sort(users_array.begin(), users_array.end());
         } else {
@@ -298,7 +406,9 @@ struct Router
             src_wires[src_wire] = ctx->getWireDelay(src_wire).maxDelay();
         } else {
             // re-use existing routes as much as possible
-            if (net_info->wires.count(src_wire) == 0)
+            if (searchOnly)
+                searchedSrc = src_wire;
+            else if (net_info->wires.count(src_wire) == 0)
                 ctx->bindWire(src_wire, ctx->nets.at(net_name).get(), STRENGTH_WEAK);
             src_wires[src_wire] = ctx->getWireDelay(src_wire).maxDelay();
 
@@ -343,6 +453,10 @@ struct Router
                 if (src_wires.count(it.first) == 0)
                     ripup_wires.push_back(it.first);
 
+            // Leave nets with dangling wires to be routed the usual way
+            if (searchOnly && !ripup_wires.empty())
+                return;
+
             for (auto &it : ripup_wires) {
                 if (ctx->debug)
                     log("  Unbind dangling wire for net %s: %s\n", net_name.c_str(ctx),
@@ -364,12 +478,34 @@ struct Router
                 log_error("No wire found for port %s on destination cell %s.\n",
                           net_info->users[user_idx].port.c_str(ctx), net_info->users[user_idx].cell->name.c_str(ctx));
 
+            // Already reached by the existing routing of the net
+            if (src_wires.count(dst_wire)) {
+                if (ctx->debug)
+                    log("    Already routed.\n");
+                continue;
+            }
+
             if (ctx->debug) {
                 log("    Destination wire: %s\n", ctx->getWireName(dst_wire).c_str(ctx));
                 log("    Path delay estimate: %.2f\n", float(ctx->estimateDelay(src_wire, dst_wire)));
             }
 
             route(src_wires, dst_wire);
+            arcCnt++;
+
+            // A search only router gives up on anything else
+            if (searchOnly && visited.count(dst_wire) == 0)
+                return;
+
+            if (visited.count(dst_wire) == 0 && bbLimited) {
+                // Only search the whole device if the bounding box was not enough
+                if (ctx->debug)
+                    log("    Widening search beyond the bounding box of the net.\n");
+                widenCnt++;
+                bbLimited = false;
+                route(src_wires, dst_wire);
+                bbLimited = true;
+            }
 
             if (visited.count(dst_wire) == 0) {
                 if (ctx->debug)
@@ -411,6 +547,7 @@ struct Router
 
                     rippedNets.insert(conflicting_wire_net->name);
                     scores.wireScores[cursor]++;
+                    scores.changedWires.insert(cursor);
                     scores.netWireScores[std::make_pair(net_name, cursor)]++;
                     scores.netWireScores[std::make_pair(conflicting_wire_net->name, cursor)]++;
                 }
@@ -434,13 +571,50 @@ struct Router
                     scores.netPipScores[std::make_pair(conflicting_pip_net->name, visited[cursor].pip)]++;
                 }
 
-                ctx->bindPip(visited[cursor].pip, ctx->nets.at(net_name).get(), STRENGTH_WEAK);
+                if (searchOnly)
+                    searchedPips.push_back(visited[cursor].pip);
+                else
+                    ctx->bindPip(visited[cursor].pip, ctx->nets.at(net_name).get(), STRENGTH_WEAK);
                 src_wires[cursor] = visited[cursor].delay;
                 cursor = ctx->getPipSrcWire(visited[cursor].pip);
             }
         }
 
         routedOkay = true;
+        if (!searchOnly)
+            ctx->cacheNetinfoRouteDelays(net_info);
+    }
+
+    // Bind the routing found by a search only router, unless other nets have
+    // taken some of it since, in which case nothing is bound. Returns whether
+    // the routing was bound.
+    bool commit()
+    {
+        NPNR_ASSERT(searchOnly && routedOkay);
+        NetInfo *net_info = ctx->nets.at(net_name).get();
+
+        bool boundSrc = false;
+        if (net_info->wires.count(searchedSrc) == 0) {
+            if (!ctx->checkWireAvail(searchedSrc))
+                return false;
+            ctx->bindWire(searchedSrc, net_info, STRENGTH_WEAK);
+            boundSrc = true;
+        }
+
+        for (size_t i = 0; i < searchedPips.size(); i++) {
+            PipId pip = searchedPips.at(i);
+            if (!ctx->checkPipAvail(pip) || !ctx->checkWireAvail(ctx->getPipDstWire(pip))) {
+                while (i > 0)
+                    ctx->unbindPip(searchedPips.at(--i));
+                if (boundSrc)
+                    ctx->unbindWire(searchedSrc);
+                return false;
+            }
+            ctx->bindPip(pip, net_info, STRENGTH_WEAK);
+        }
+
+        ctx->cacheNetinfoRouteDelays(net_info);
+        return true;
     }
 };
 
@@ -552,6 +726,8 @@ void addNetRouteJobs(Context *ctx, const Router1Cfg &cfg, IdString net_name,
     if (net_cache.empty())
         net_cache.resize(net_info->users.size());
 
+    RouteJob net_job;
+
     for (int user_idx = 0; user_idx < int(net_info->users.size()); user_idx++) {
         if (net_cache[user_idx])
             continue;
@@ -571,7 +747,16 @@ void addNetRouteJobs(Context *ctx, const Router1Cfg &cfg, IdString net_name,
                 job.user_idx = user_idx;
                 job.slack = net_info->users[user_idx].budget - ctx->estimateDelay(src_wire, dst_wire);
                 job.randtag = ctx->rng();
-                queue.push(job);
+                if (cfg.netTree) {
+                    // Route the whole net in one job, as soon as its most
+                    // critical unrouted user needs it
+                    if (net_job.net == IdString() || job.slack < net_job.slack) {
+                        net_job = job;
+                        net_job.user_idx = -1;
+                    }
+                } else {
+                    queue.push(job);
+                }
                 net_cache[user_idx] = true;
                 break;
             }
@@ -579,6 +764,9 @@ void addNetRouteJobs(Context *ctx, const Router1Cfg &cfg, IdString net_name,
             cursor = ctx->getPipSrcWire(it->second.pip);
         }
     }
+
+    if (net_job.net != IdString())
+        queue.push(net_job);
 }
 
 void cleanupReroute(Context *ctx, const Router1Cfg &cfg, RipupScoreboard &scores,
@@ -661,11 +849,12 @@ void cleanupReroute(Context *ctx, const Router1Cfg &cfg, RipupScoreboard &scores
 
         ctx->unbindWire(dst_wire);
 
-        Router router(ctx, cfg, scores, net_name, user_idx, false, false);
+        Router router(ctx, cfg, scores, net_name, user_idx, job.randtag, false, false);
 
         if (!router.routedOkay)
             log_error("Failed to re-route arc %d of net %s.\n", user_idx, net_name.c_str(ctx));
 
+        scores.countArcs(net_name, router.arcCnt, router.widenCnt);
         visitCnt += router.visitCnt;
         revisitCnt += router.revisitCnt;
         overtimeRevisitCnt += router.overtimeRevisitCnt;
@@ -684,6 +873,82 @@ void cleanupReroute(Context *ctx, const Router1Cfg &cfg, RipupScoreboard &scores
     totalOvertimeRevisitCnt += overtimeRevisitCnt;
 }
 
+// Most jobs searched in parallel at a time
+const size_t route_batch_size = 64;
+
+// Take the next jobs to search in parallel from the queue: as many as follow
+// each other in queue order with nets whose bounding boxes do not overlap.
+// Taking no job out of order keeps the routing the same as routing them one
+// by one, unless their searches meet outside of the boxes. A job without a
+// bounding box is taken alone.
+std::vector<RouteJob> takeRouteBatch(Context *ctx, const Router1Cfg &cfg,
+                                     std::priority_queue<RouteJob, std::vector<RouteJob>, RouteJob::Greater> &queue)
+{
+    std::vector<RouteJob> batch;
+    std::vector<BoundingBox> boxes;
+
+    while (!queue.empty() && batch.size() < route_batch_size) {
+        const RouteJob &job = queue.top();
+        BoundingBox bb;
+        if (!getNetBoundingBox(ctx, cfg, ctx->nets.at(job.net).get(), bb)) {
+            if (batch.empty()) {
+                batch.push_back(job);
+                queue.pop();
+            }
+            break;
+        }
+
+        bool overlaps = false;
+        for (auto &other : boxes)
+            if (bb.overlaps(other))
+                overlaps = true;
+        if (overlaps)
+            break;
+
+        batch.push_back(job);
+        boxes.push_back(bb);
+        queue.pop();
+    }
+
+    return batch;
+}
+
+// Search the routing of a batch of jobs on cfg.threads threads, binding none
+// of it, which leaves the Arch unchanged while the searches read it. The
+// searches do not rip up, so they share the scoreboard without touching it.
+std::vector<std::unique_ptr<Router>> searchRouteBatch(Context *ctx, const Router1Cfg &cfg, RipupScoreboard &scores,
+                                                      const std::vector<RouteJob> &batch)
+{
+    std::vector<std::unique_ptr<Router>> routers(batch.size());
+    std::atomic<size_t> next_job(0);
+    int n_threads = std::max(1, std::min(cfg.threads, int(batch.size())));
+    // Errors, such as from log_error, are rethrown on the main thread once
+    // all workers have stopped
+    std::vector<std::exception_ptr> errors(n_threads);
+    auto worker = [&](int thread_idx) {
+        try {
+            for (size_t i = next_job++; i < batch.size(); i = next_job++)
+                routers.at(i).reset(
+                        new Router(ctx, cfg, scores, batch.at(i).net, batch.at(i).user_idx, batch.at(i).randtag, false,
+                                   false, 0, true));
+        } catch (...) {
+            errors.at(thread_idx) = std::current_exception();
+            next_job = batch.size();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < n_threads; i++)
+        workers.emplace_back(worker, i);
+    worker(0);
+    for (auto &t : workers)
+        t.join();
+    for (auto &e : errors)
+        if (e)
+            std::rethrow_exception(e);
+    return routers;
+}
+
 } // namespace
 
 NEXTPNR_NAMESPACE_BEGIN
@@ -694,6 +959,9 @@ Router1Cfg::Router1Cfg(Context *ctx) : Settings(ctx)
     cleanupReroute = get<bool>("router1/cleanupReroute", true);
     fullCleanupReroute = get<bool>("router1/fullCleanupReroute", true);
     useEstimate = get<bool>("router1/useEstimate", true);
+    bbMargin = get<int>("router1/bbMargin", -1);
+    netTree = get<bool>("router1/netTree", false);
+    threads = get<int>("router1/threads", 1);
 }
 
 bool router1(Context *ctx, const Router1Cfg &cfg)
@@ -706,6 +974,9 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
         log_break();
         log_info("Routing..\n");
         ctx->lock();
+        TelemetryPhase phase("route/main");
+        int64_t totalJobCnt = 0;
+        int batchedJobCnt = 0, batchRetryCnt = 0;
 
         std::unordered_set<IdString> cleanupQueue;
         std::unordered_map<IdString, std::vector<bool>> jobCache;
@@ -740,6 +1011,7 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
                 log_info("-- %d --\n", iterCnt);
 
             int visitCnt = 0, revisitCnt = 0, overtimeRevisitCnt = 0, jobCnt = 0, failedCnt = 0;
+            std::vector<double> jobVisitCnts;
 
             std::unordered_set<IdString> normalRouteNets, ripupQueue;
 
@@ -751,43 +1023,74 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
             bool printNets = ctx->verbose && (jobQueue.size() < 10);
 
             while (!jobQueue.empty()) {
-                if (ctx->debug)
-                    log("Next job slack: %f\n", double(jobQueue.top().slack));
-
-                auto net_name = jobQueue.top().net;
-                auto user_idx = jobQueue.top().user_idx;
-                jobQueue.pop();
+                // With threads to spare, search batches of jobs in parallel
+                // and bind their routing in queue order, routing again as
+                // usual any job whose search failed or was overtaken by
+                // another one of the batch
+                std::vector<RouteJob> batch;
+                std::vector<std::unique_ptr<Router>> searched;
+                if (cfg.threads > 1 && !ctx->debug) {
+                    batch = takeRouteBatch(ctx, cfg, jobQueue);
+                    if (batch.size() > 1)
+                        searched = searchRouteBatch(ctx, cfg, scores, batch);
+                } else {
+                    batch.push_back(jobQueue.top());
+                    jobQueue.pop();
+                }
 
-                if (cfg.fullCleanupReroute)
-                    cleanupQueue.insert(net_name);
+                for (size_t i = 0; i < batch.size(); i++) {
+                    if (ctx->debug)
+                        log("Next job slack: %f\n", double(batch.at(i).slack));
 
-                if (printNets) {
-                    if (user_idx < 0)
-                        log_info("  routing all %d users of net %s\n", int(ctx->nets.at(net_name)->users.size()),
-                                 net_name.c_str(ctx));
-                    else
-                        log_info("  routing user %d of net %s\n", user_idx, net_name.c_str(ctx));
-                }
+                    auto net_name = batch.at(i).net;
+                    auto user_idx = batch.at(i).user_idx;
 
-                Router router(ctx, cfg, scores, net_name, user_idx, false, false);
+                    if (cfg.fullCleanupReroute)
+                        cleanupQueue.insert(net_name);
 
-                jobCnt++;
-                visitCnt += router.visitCnt;
-                revisitCnt += router.revisitCnt;
-                overtimeRevisitCnt += router.overtimeRevisitCnt;
+                    if (printNets) {
+                        if (user_idx < 0)
+                            log_info("  routing all %d users of net %s\n", int(ctx->nets.at(net_name)->users.size()),
+                                     net_name.c_str(ctx));
+                        else
+                            log_info("  routing user %d of net %s\n", user_idx, net_name.c_str(ctx));
+                    }
 
-                if (!router.routedOkay) {
-                    if (printNets)
-                        log_info("    failed to route to %s.\n", ctx->getWireName(router.failedDest).c_str(ctx));
-                    ripupQueue.insert(net_name);
-                    failedCnt++;
-                } else {
-                    normalRouteNets.insert(net_name);
-                }
+                    std::unique_ptr<Router> router;
+                    if (i < searched.size()) {
+                        batchedJobCnt++;
+                        if (searched.at(i)->routedOkay && searched.at(i)->commit())
+                            router = std::move(searched.at(i));
+                        else
+                            batchRetryCnt++;
+                    }
+                    if (router == nullptr)
+                        router.reset(
+                                new Router(ctx, cfg, scores, net_name, user_idx, batch.at(i).randtag, false, false));
+
+                    scores.countArcs(net_name, router->arcCnt, router->widenCnt);
+                    jobVisitCnts.push_back(router->visitCnt);
+                    jobCnt++;
+                    visitCnt += router->visitCnt;
+                    revisitCnt += router->revisitCnt;
+                    overtimeRevisitCnt += router->overtimeRevisitCnt;
+
+                    if (!router->routedOkay) {
+                        if (printNets)
+                            log_info("    failed to route to %s.\n",
+                                     ctx->getWireName(router->failedDest).c_str(ctx));
+                        ripupQueue.insert(net_name);
+                        failedCnt++;
+                    } else {
+                        normalRouteNets.insert(net_name);
+                    }
 
-                if ((ctx->verbose || iterCnt == 1) && !printNets && (jobCnt % 100 == 0)) {
-                    log_info("  processed %d jobs. (%d routed, %d failed)\n", jobCnt, jobCnt - failedCnt, failedCnt);
-                    ctx->yield();
+                    if ((ctx->verbose || iterCnt == 1) && !printNets && (jobCnt % 100 == 0)) {
+                        log_info("  processed %d jobs. (%d routed, %d failed)\n", jobCnt, jobCnt - failedCnt,
+                                 failedCnt);
+                        scores.sampleUi(ctx);
+                        ctx->yield();
+                    }
                 }
             }
 
@@ -796,6 +1099,7 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
 
             if ((ctx->verbose || iterCnt == 1) && (jobCnt % 100 != 0)) {
                 log_info("  processed %d jobs. (%d routed, %d failed)\n", jobCnt, jobCnt - failedCnt, failedCnt);
+                scores.sampleUi(ctx);
                 ctx->yield();
             }
 
@@ -809,6 +1113,9 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
 
                 printNets = ctx->verbose && (ripupQueue.size() < 10);
 
+                totalVisitCnt += visitCnt;
+                totalRevisitCnt += revisitCnt;
+                totalOvertimeRevisitCnt += overtimeRevisitCnt;
                 visitCnt = 0;
                 revisitCnt = 0;
                 overtimeRevisitCnt = 0;
@@ -826,8 +1133,9 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
                         log_info("  routing net %s. (%d users)\n", net_name.c_str(ctx),
                                  int(ctx->nets.at(net_name)->users.size()));
 
-                    Router router(ctx, cfg, scores, net_name, -1, false, true, ripup_penalty);
+                    Router router(ctx, cfg, scores, net_name, -1, ctx->rng(), false, true, ripup_penalty);
 
+                    scores.countArcs(net_name, router.arcCnt, router.widenCnt);
                     netCnt++;
                     visitCnt += router.visitCnt;
                     revisitCnt += router.revisitCnt;
@@ -856,12 +1164,14 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
 
                     if ((ctx->verbose || iterCnt == 1) && !printNets && (netCnt % 100 == 0)) {
                         log_info("  routed %d nets, ripped %d nets.\n", netCnt, ripCnt);
+                        scores.sampleUi(ctx);
                         ctx->yield();
                     }
                 }
 
                 if ((ctx->verbose || iterCnt == 1) && (netCnt % 100 != 0))
                     log_info("  routed %d nets, ripped %d nets.\n", netCnt, ripCnt);
+                telemetry_count("route/ripped_nets", ripCnt);
 
                 if (ctx->verbose)
                     log_info("  visited %d PIPs (%.2f%% revisits, %.2f%% overtime revisits).\n", visitCnt,
@@ -878,6 +1188,13 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
             totalVisitCnt += visitCnt;
             totalRevisitCnt += revisitCnt;
             totalOvertimeRevisitCnt += overtimeRevisitCnt;
+            totalJobCnt += jobCnt;
+
+            telemetry_count("route/iterations");
+            telemetry_count("route/jobs", jobCnt);
+            telemetry_count("route/failed_jobs", failedCnt);
+            telemetry_count("route/ripup_queue_nets", ripupQueue.size());
+            telemetry_samples("route/visited_per_job", jobVisitCnts);
 
             if (iterCnt == 8 || iterCnt == 16 || iterCnt == 32 || iterCnt == 64 || iterCnt == 128)
                 ripup_penalty += ctx->getRipupDelayPenalty();
@@ -886,14 +1203,50 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
                 cleanupReroute(ctx, cfg, scores, cleanupQueue, jobQueue, totalVisitCnt, totalRevisitCnt,
                                totalOvertimeRevisitCnt);
 
+            scores.sampleUi(ctx);
+
             ctx->yield();
         }
 
         log_info("routing complete after %d iterations.\n", iterCnt);
+        telemetry_count("route/visits", totalVisitCnt);
+        telemetry_count("route/revisits", totalRevisitCnt);
+        if (totalJobCnt > 0)
+            telemetry_gauge("route/jobs_per_sec", totalJobCnt / std::max(phase.elapsed(), 1e-9));
+        {
+            size_t wires = 0;
+            for (auto &net_it : ctx->nets)
+                wires += net_it.second->wires.size();
+            telemetry_gauge("route/wires", wires);
+        }
 
         log_info("visited %d PIPs (%.2f%% revisits, %.2f%% overtime revisits).\n", totalVisitCnt,
                  (100.0 * totalRevisitCnt) / totalVisitCnt, (100.0 * totalOvertimeRevisitCnt) / totalVisitCnt);
 
+        if (cfg.threads > 1) {
+            log_info("searched %d jobs in parallel on %d threads, routing %d of them again.\n", batchedJobCnt,
+                     cfg.threads, batchRetryCnt);
+            telemetry_count("route/batched_jobs", batchedJobCnt);
+            telemetry_count("route/batch_retries", batchRetryCnt);
+        }
+
+        if (cfg.bbMargin >= 0) {
+            int widenCnt = 0;
+            std::vector<std::pair<int, IdString>> widenedNets;
+            for (auto &it : scores.netWidenCnt) {
+                widenCnt += it.second;
+                widenedNets.push_back(std::make_pair(-it.second, it.first));
+            }
+            log_info("searched beyond the net bounding box for %d of %d arcs (%.2f%%, %d nets).\n", widenCnt,
+                     scores.arcCnt, (100.0 * widenCnt) / std::max(1, scores.arcCnt), int(widenedNets.size()));
+            if (ctx->verbose) {
+                std::sort(widenedNets.begin(), widenedNets.end());
+                for (size_t i = 0; i < widenedNets.size() && i < 10; i++)
+                    log_info("  net %s: %d arcs\n", widenedNets.at(i).second.c_str(ctx), -widenedNets.at(i).first);
+            }
+            telemetry_count("route/bb_widened_arcs", widenCnt);
+        }
+
         {
             float tns = 0;
             int tns_net_count = 0;
@@ -970,7 +1323,7 @@ bool Context::getActualRouteDelay(WireId src_wire, WireId dst_wire, delay_t *del
     Router1Cfg cfg(this);
     cfg.useEstimate = useEstimate;
 
-    Router router(this, cfg, scores, src_wire, dst_wire);
+    Router router(this, cfg, scores, src_wire, dst_wire, rng());
 
     if (!router.routedOkay)
         return false;
@@ -33,6 +33,19 @@ struct Router1Cfg : Settings
     bool cleanupReroute;
     bool fullCleanupReroute;
     bool useEstimate;
+    // Confine the search for each arc to the bounding box of its net, grown
+    // by this many tiles, searching the whole device only if that fails. A
+    // negative margin, the default, always searches the whole device.
+    int bbMargin;
+    // Route all unrouted users of a net in one job, nearest first, each
+    // extending the routing tree built for the ones before, instead of
+    // routing each user in its own job.
+    bool netTree;
+    // Threads to search for routes on. With more than one, the first routing
+    // of batches of nets with disjoint bounding boxes is searched for in
+    // parallel, and bound in queue order. Nets only have bounding boxes with
+    // a bbMargin of zero or more.
+    int threads;
 };
 
 extern bool router1(Context *ctx, const Router1Cfg &cfg);
@@ -0,0 +1,140 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "seed_sweep.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "log.h"
+#include "place_common.h"
+#include "telemetry.h"
+#include "timing.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+
+struct SeedRun
+{
+    int seed;
+    std::unique_ptr<Context> ctx;
+    std::string log;
+    bool ok = false;
+    double fmax = 0;
+    wirelen_t wirelength = 0;
+    double seconds = 0;
+};
+
+void place_and_route(SeedRun &run)
+{
+    Context *ctx = run.ctx.get();
+    TelemetryPhase phase("seeds/run");
+    // Each run reports under its own seed, as they would be summed up
+    // otherwise; the kept one is also reported at the top level below.
+    TelemetryScope scope(stringf("seeds/%d/", run.seed));
+    // The log of each run is kept apart, so that only the best is printed.
+    log_capture = &run.log;
+    try {
+        if (!ctx->place() && !ctx->force)
+            log_error("Placing design failed.\n");
+        ctx->check();
+        if (!ctx->route() && !ctx->force)
+            log_error("Routing design failed.\n");
+
+        run.fmax = timing_analysis(ctx, false /* slack_histogram */, false /* print_path */);
+        float tns = 0;
+        for (auto &net : ctx->nets)
+            run.wirelength += get_net_metric(ctx, net.second.get(), MetricType::WIRELENGTH, tns);
+        run.ok = true;
+    } catch (log_execution_error_exception) {
+        // Already in the log
+    } catch (std::exception &e) {
+        run.log += stringf("ERROR: %s\n", e.what());
+    }
+    log_capture = nullptr;
+    run.seconds = phase.elapsed();
+}
+
+bool better(const SeedRun &a, const SeedRun &b)
+{
+    if (a.ok != b.ok)
+        return a.ok;
+    if (a.fmax != b.fmax)
+        return a.fmax > b.fmax;
+    return a.wirelength < b.wirelength;
+}
+
+} // namespace
+
+std::unique_ptr<Context> place_and_route_seeds(const Context *ctx, const std::vector<int> &seeds, int threads)
+{
+    NPNR_ASSERT(!seeds.empty());
+    threads = std::max(1, std::min(threads, int(seeds.size())));
+    log_break();
+    log_info("Placing and routing with %d seeds using %d threads..\n", int(seeds.size()), threads);
+
+    // Cloning only reads the packed design, but is done up front as reading
+    // it while the Arch lazily fills its caches would not be thread safe.
+    std::vector<SeedRun> runs(seeds.size());
+    for (size_t i = 0; i < seeds.size(); i++) {
+        runs.at(i).seed = seeds.at(i);
+        runs.at(i).ctx = ctx->clone();
+        runs.at(i).ctx->rngseed(seeds.at(i));
+    }
+
+    std::atomic<size_t> next_run(0);
+    auto worker = [&]() {
+        for (size_t i = next_run++; i < runs.size(); i = next_run++)
+            place_and_route(runs.at(i));
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; i++)
+        workers.emplace_back(worker);
+    worker();
+    for (auto &t : workers)
+        t.join();
+
+    size_t best = 0;
+    for (size_t i = 1; i < runs.size(); i++)
+        if (better(runs.at(i), runs.at(best)))
+            best = i;
+
+    log_break();
+    log_info("Log of the run with seed %d:\n", runs.at(best).seed);
+    log_always("%s", runs.at(best).log.c_str());
+    log_break();
+
+    log_info("Seed sweep results:\n");
+    for (auto &run : runs) {
+        if (run.ok)
+            log_info("    seed %6d: Fmax %8.2f MHz, wirelength %8d, %7.2fs\n", run.seed, run.fmax,
+                     int(run.wirelength), run.seconds);
+        else
+            log_info("    seed %6d: failed, %7.2fs\n", run.seed, run.seconds);
+    }
+    if (!runs.at(best).ok)
+        return nullptr;
+    log_info("Keeping the result of seed %d.\n", runs.at(best).seed);
+
+    // The runs recorded their results as they finished; report the kept one.
+    telemetry_gauge("sta/fmax_mhz", runs.at(best).fmax);
+    telemetry_gauge("place/wirelength", runs.at(best).wirelength);
+    telemetry_gauge("seeds/best_seed", runs.at(best).seed);
+    return std::move(runs.at(best).ctx);
+}
+
+NEXTPNR_NAMESPACE_END
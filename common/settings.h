@@ -50,7 +50,7 @@ class Settings
         IdString id = ctx->id(name);
         auto pair = ctx->settings.emplace(id, std::to_string(value));
         if (!pair.second) {
-            ctx->settings[pair.first->first] = value;
+            ctx->settings[pair.first->first] = std::to_string(value);
         }
     }
 
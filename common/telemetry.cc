@@ -0,0 +1,267 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "telemetry.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <vector>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+
+struct PhaseStats
+{
+    double seconds = 0;
+    int count = 0;
+    int64_t peak_rss = 0;
+};
+
+struct Histogram
+{
+    int64_t count = 0;
+    double sum = 0, min = 0, max = 0;
+    // Bucket 0 holds samples below 1, bucket i those in [2^(i-1), 2^i).
+    std::vector<int64_t> buckets;
+};
+
+struct Telemetry
+{
+    std::mutex mutex;
+    // Ordered maps keep the report stable between runs.
+    std::map<std::string, PhaseStats> phases;
+    std::map<std::string, int64_t> counters;
+    std::map<std::string, double> gauges;
+    std::map<std::string, Histogram> histograms;
+};
+
+Telemetry &telemetry()
+{
+    static Telemetry t;
+    return t;
+}
+
+thread_local std::string scope_prefix;
+
+void write_string(std::ostream &out, const std::string &str)
+{
+    out << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec << std::setfill(' ');
+        else
+            out << c;
+    }
+    out << '"';
+}
+
+void write_number(std::ostream &out, double value)
+{
+    if (std::isfinite(value))
+        out << value;
+    else
+        out << "null";
+}
+
+} // namespace
+
+TelemetryPhase::TelemetryPhase(const std::string &name)
+        : name(scope_prefix + name), start(std::chrono::steady_clock::now())
+{
+}
+
+TelemetryPhase::~TelemetryPhase()
+{
+    double seconds = elapsed();
+    int64_t peak_rss = telemetry_peak_rss();
+    auto &t = telemetry();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    auto &phase = t.phases[name];
+    phase.seconds += seconds;
+    phase.count++;
+    phase.peak_rss = std::max(phase.peak_rss, peak_rss);
+}
+
+double TelemetryPhase::elapsed() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+TelemetryScope::TelemetryScope(const std::string &prefix) : outer(scope_prefix) { scope_prefix += prefix; }
+
+TelemetryScope::~TelemetryScope() { scope_prefix = outer; }
+
+void telemetry_count(const std::string &name, int64_t value)
+{
+    auto &t = telemetry();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    t.counters[scope_prefix + name] += value;
+}
+
+void telemetry_gauge(const std::string &name, double value)
+{
+    auto &t = telemetry();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    t.gauges[scope_prefix + name] = value;
+}
+
+static void add_sample(Histogram &hist, double value)
+{
+    size_t bucket = 0;
+    if (value >= 1)
+        bucket = std::min<size_t>(63, size_t(std::floor(std::log2(value))) + 1);
+
+    if (hist.count == 0 || value < hist.min)
+        hist.min = value;
+    if (hist.count == 0 || value > hist.max)
+        hist.max = value;
+    hist.count++;
+    hist.sum += value;
+    if (hist.buckets.size() <= bucket)
+        hist.buckets.resize(bucket + 1);
+    hist.buckets.at(bucket)++;
+}
+
+void telemetry_sample(const std::string &name, double value)
+{
+    auto &t = telemetry();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    add_sample(t.histograms[scope_prefix + name], value);
+}
+
+void telemetry_samples(const std::string &name, const std::vector<double> &values)
+{
+    if (values.empty())
+        return;
+    auto &t = telemetry();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    auto &hist = t.histograms[scope_prefix + name];
+    for (auto value : values)
+        add_sample(hist, value);
+}
+
+int64_t telemetry_peak_rss()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return int64_t(usage.ru_maxrss);
+#else
+    // Linux and the BSDs report kilobytes.
+    return int64_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+void telemetry_reset()
+{
+    auto &t = telemetry();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    t.phases.clear();
+    t.counters.clear();
+    t.gauges.clear();
+    t.histograms.clear();
+}
+
+void telemetry_write_json(std::ostream &out)
+{
+    auto &t = telemetry();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    out << std::setprecision(9);
+
+    out << "{\n  \"peak_rss_bytes\": " << telemetry_peak_rss() << ",\n";
+
+    out << "  \"phases\": {";
+    bool first = true;
+    for (auto &phase : t.phases) {
+        out << (first ? "\n    " : ",\n    ");
+        write_string(out, phase.first);
+        out << ": {\"seconds\": ";
+        write_number(out, phase.second.seconds);
+        out << ", \"count\": " << phase.second.count << ", \"peak_rss_bytes\": " << phase.second.peak_rss << "}";
+        first = false;
+    }
+    out << (first ? "},\n" : "\n  },\n");
+
+    out << "  \"counters\": {";
+    first = true;
+    for (auto &counter : t.counters) {
+        out << (first ? "\n    " : ",\n    ");
+        write_string(out, counter.first);
+        out << ": " << counter.second;
+        first = false;
+    }
+    out << (first ? "},\n" : "\n  },\n");
+
+    out << "  \"gauges\": {";
+    first = true;
+    for (auto &gauge : t.gauges) {
+        out << (first ? "\n    " : ",\n    ");
+        write_string(out, gauge.first);
+        out << ": ";
+        write_number(out, gauge.second);
+        first = false;
+    }
+    out << (first ? "},\n" : "\n  },\n");
+
+    out << "  \"histograms\": {";
+    first = true;
+    for (auto &entry : t.histograms) {
+        auto &hist = entry.second;
+        out << (first ? "\n    " : ",\n    ");
+        write_string(out, entry.first);
+        out << ": {\"count\": " << hist.count << ", \"sum\": ";
+        write_number(out, hist.sum);
+        out << ", \"min\": ";
+        write_number(out, hist.min);
+        out << ", \"max\": ";
+        write_number(out, hist.max);
+        out << ", \"mean\": ";
+        write_number(out, hist.sum / hist.count);
+        // Only non-empty buckets are written, each with its exclusive upper
+        // bound.
+        out << ", \"buckets\": [";
+        bool first_bucket = true;
+        for (size_t i = 0; i < hist.buckets.size(); i++) {
+            if (hist.buckets.at(i) == 0)
+                continue;
+            out << (first_bucket ? "" : ", ") << "{\"lt\": ";
+            write_number(out, std::ldexp(1.0, int(i)));
+            out << ", \"count\": " << hist.buckets.at(i) << "}";
+            first_bucket = false;
+        }
+        out << "]}";
+        first = false;
+    }
+    out << (first ? "}\n" : "\n  }\n");
+
+    out << "}\n";
+}
+
+NEXTPNR_NAMESPACE_END
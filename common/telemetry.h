@@ -0,0 +1,88 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// Performance telemetry, written out as JSON with --report-perf. Names are
+// grouped by the engine reporting them, e.g. "place/moves". All functions
+// may be called from any thread, but take a lock, so engines should sum up
+// locally in their inner loops and report once per iteration.
+
+// Records the wall clock time spent in a phase of processing while in
+// scope. Phases of the same name are accumulated. The peak resident set
+// size of the process at the end of each phase is recorded too.
+class TelemetryPhase
+{
+  public:
+    TelemetryPhase(const std::string &name);
+    ~TelemetryPhase();
+
+    // Seconds since the phase started.
+    double elapsed() const;
+
+  private:
+    std::string name;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Prefixes every name reported from this thread while in scope, so that
+// runs made concurrently, such as those of --parallel-seeds, are reported
+// apart instead of summed up. Threads started within the scope do not
+// inherit the prefix, so engines report from the thread that called them.
+class TelemetryScope
+{
+  public:
+    TelemetryScope(const std::string &prefix);
+    ~TelemetryScope();
+
+  private:
+    std::string outer;
+};
+
+// Add to a monotonic counter.
+void telemetry_count(const std::string &name, int64_t value = 1);
+
+// Set a value that is only meaningful as a whole, such as a rate.
+void telemetry_gauge(const std::string &name, double value);
+
+// Add a sample to a histogram with power of two buckets.
+void telemetry_sample(const std::string &name, double value);
+
+// Add many samples to a histogram at once, taking the lock only once.
+void telemetry_samples(const std::string &name, const std::vector<double> &values);
+
+// Peak resident set size of the process so far, in bytes, or 0 if unknown.
+int64_t telemetry_peak_rss();
+
+// Discard everything recorded so far.
+void telemetry_reset();
+
+void telemetry_write_json(std::ostream &out);
+
+NEXTPNR_NAMESPACE_END
+
+#endif
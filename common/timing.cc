@@ -25,6 +25,7 @@
 #include <unordered_map>
 #include <utility>
 #include "log.h"
+#include "telemetry.h"
 #include "util.h"
 
 NEXTPNR_NAMESPACE_BEGIN
@@ -327,7 +328,10 @@ void assign_budget(Context *ctx, bool quiet)
     }
 
     Timing timing(ctx, ctx->slack_redist_iter > 0 /* net_delays */, true /* update */);
-    timing.assign_budget();
+    {
+        TelemetryPhase phase("sta/budget");
+        timing.assign_budget();
+    }
 
     if (!quiet || ctx->verbose) {
         for (auto &net : ctx->nets) {
@@ -362,14 +366,18 @@ void assign_budget(Context *ctx, bool quiet)
         log_info("Checksum: 0x%08x\n", ctx->checksum());
 }
 
-void timing_analysis(Context *ctx, bool print_histogram, bool print_path)
+double timing_analysis(Context *ctx, bool print_histogram, bool print_path)
 {
     PortRefVector crit_path;
     DelayFrequency slack_histogram;
 
     Timing timing(ctx, true /* net_delays */, false /* update */, print_path ? &crit_path : nullptr,
                   print_histogram ? &slack_histogram : nullptr);
-    auto min_slack = timing.walk_paths();
+    delay_t min_slack;
+    {
+        TelemetryPhase phase("sta/analysis");
+        min_slack = timing.walk_paths();
+    }
 
     if (print_path) {
         if (crit_path.empty()) {
@@ -412,7 +420,9 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_path)
     }
 
     delay_t default_slack = delay_t((1.0e9 / ctx->getDelayNS(1)) / ctx->target_freq);
-    log_info("estimated Fmax = %.2f MHz\n", 1e3 / ctx->getDelayNS(default_slack - min_slack));
+    double fmax = 1e3 / ctx->getDelayNS(default_slack - min_slack);
+    log_info("estimated Fmax = %.2f MHz\n", fmax);
+    telemetry_gauge("sta/fmax_mhz", fmax);
 
     if (print_histogram && slack_histogram.size() > 0) {
         unsigned num_bins = 20;
@@ -439,6 +449,7 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_path)
                      std::string(bins[i] * bar_width / max_freq, '*').c_str(),
                      (bins[i] * bar_width) % max_freq > 0 ? '+' : ' ');
     }
+    return fmax;
 }
 
 NEXTPNR_NAMESPACE_END
@@ -28,8 +28,8 @@ NEXTPNR_NAMESPACE_BEGIN
 void assign_budget(Context *ctx, bool quiet = false);
 
 // Perform timing analysis and print out the fmax, and optionally the
-//    critical path
-void timing_analysis(Context *ctx, bool slack_histogram = true, bool print_path = false);
+//    critical path. Returns the estimated fmax in MHz.
+double timing_analysis(Context *ctx, bool slack_histogram = true, bool print_path = false);
 
 NEXTPNR_NAMESPACE_END
 
@@ -20,9 +20,11 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include <exception>
 #include <map>
 #include <set>
 #include <string>
+#include <thread>
 #include "nextpnr.h"
 
 NEXTPNR_NAMESPACE_BEGIN
@@ -97,6 +99,39 @@ inline const NetInfo *get_net_or_empty(const CellInfo *cell, const IdString port
         return nullptr;
 };
 
+// Split the range [0, n) into contiguous chunks, one per hardware thread, and
+// call func(begin, end) for each chunk on its own thread. func must only read
+// shared state (including looking up, never creating, IdStrings) and write its
+// results to per-index storage, so that the caller can merge them in a
+// deterministic order afterwards. Exceptions are rethrown on the calling thread.
+template <typename F> void parallel_for_chunks(size_t n, F func, size_t min_chunk = 1024)
+{
+    size_t n_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    n_threads = std::min(n_threads, std::max<size_t>(1, n / min_chunk));
+    if (n_threads <= 1) {
+        func(size_t(0), n);
+        return;
+    }
+    size_t chunk = (n + n_threads - 1) / n_threads;
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(n_threads);
+    for (size_t i = 0; i < n_threads; i++) {
+        size_t begin = std::min(n, i * chunk), end = std::min(n, (i + 1) * chunk);
+        workers.emplace_back([&func, &errors, i, begin, end]() {
+            try {
+                func(begin, end);
+            } catch (...) {
+                errors.at(i) = std::current_exception();
+            }
+        });
+    }
+    for (auto &w : workers)
+        w.join();
+    for (auto &e : errors)
+        if (e)
+            std::rethrow_exception(e);
+}
+
 NEXTPNR_NAMESPACE_END
 
 #endif
@@ -412,6 +412,17 @@ struct Arch : BaseCtx
     mutable std::unordered_map<IdString, WireId> wire_by_name;
     mutable std::unordered_map<IdString, PipId> pip_by_name;
 
+    // Control set shared by the DFFs of the slices bound in each tile,
+    // maintained by bindBel and unbindBel for constant time validity checks
+    struct SliceTileState
+    {
+        int dffs = 0;
+        // Set if the bound slices with DFFs do not share one control set
+        bool conflict = false;
+        IdString clk_sig, lsr_sig, clkmux, lsrmux, srmode;
+    };
+
+    std::vector<SliceTileState> slice_tiles;
     std::vector<CellInfo *> bel_to_cell;
     std::unordered_map<WireId, NetInfo *> wire_to_net;
     std::unordered_map<PipId, NetInfo *> pip_to_net;
@@ -424,6 +435,8 @@ struct Arch : BaseCtx
     IdString archId() const { return id("ecp5"); }
     ArchArgs archArgs() const { return args; }
     IdString archArgsToId(ArchArgs args) const;
+    // The device is entirely determined by the ArchArgs.
+    void copyDeviceFrom(const Arch &other) {}
 
     // -------------------------------------------------
 
@@ -463,6 +476,8 @@ struct Arch : BaseCtx
         int idx = getBelFlatIndex(bel);
         NPNR_ASSERT(bel_to_cell.at(idx) == nullptr);
         bel_to_cell[idx] = cell;
+        if (cell->type == id_TRELLIS_SLICE)
+            bindSliceTile(bel, cell);
         cell->bel = bel;
         cell->belStrength = strength;
         refreshUiBel(bel);
@@ -473,9 +488,12 @@ struct Arch : BaseCtx
         NPNR_ASSERT(bel != BelId());
         int idx = getBelFlatIndex(bel);
         NPNR_ASSERT(bel_to_cell.at(idx) != nullptr);
-        bel_to_cell[idx]->bel = BelId();
-        bel_to_cell[idx]->belStrength = STRENGTH_NONE;
+        CellInfo *cell = bel_to_cell[idx];
+        cell->bel = BelId();
+        cell->belStrength = STRENGTH_NONE;
         bel_to_cell[idx] = nullptr;
+        if (cell->type == id_TRELLIS_SLICE)
+            unbindSliceTile(bel, cell);
         refreshUiBel(bel);
     }
 
@@ -591,6 +609,7 @@ struct Arch : BaseCtx
         NPNR_ASSERT(wire != WireId());
         NPNR_ASSERT(wire_to_net[wire] != nullptr);
 
+        wire_to_net[wire]->route_gen++;
         auto &net_wires = wire_to_net[wire]->wires;
         auto it = net_wires.find(wire);
         NPNR_ASSERT(it != net_wires.end());
@@ -705,6 +724,7 @@ struct Arch : BaseCtx
         NPNR_ASSERT(wire_to_net[dst] != nullptr);
         wire_to_net[dst] = nullptr;
         pip_to_net[pip]->wires.erase(dst);
+        pip_to_net[pip]->route_gen++;
 
         pip_to_net[pip] = nullptr;
     }
@@ -852,6 +872,7 @@ struct Arch : BaseCtx
 
     delay_t estimateDelay(WireId src, WireId dst) const;
     delay_t predictDelay(const NetInfo *net_info, const PortRef &sink) const;
+    delay_t predictDelay(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const;
     delay_t getDelayEpsilon() const { return 20; }
     delay_t getRipupDelayPenalty() const { return 200; }
     float getDelayNS(delay_t v) const { return v * 0.001; }
@@ -886,10 +907,24 @@ struct Arch : BaseCtx
     // -------------------------------------------------
     // Placement validity checks
     bool isValidBelForCell(CellInfo *cell, BelId bel) const;
+    bool isValidBelForCell(CellInfo *cell, BelId bel, CellInfo *replaced) const;
     bool isBelLocationValid(BelId bel) const;
 
     // Helper function for above
-    bool slicesCompatible(const std::vector<const CellInfo *> &cells) const;
+    bool slicesCompatible(const CellInfo **it, const size_t size) const;
+
+    // Maintain slice_tiles as slices are bound and unbound
+    SliceTileState &getSliceTile(BelId bel)
+    {
+        return slice_tiles.at(bel.location.y * chip_info->width + bel.location.x);
+    }
+    const SliceTileState &getSliceTile(BelId bel) const
+    {
+        return slice_tiles.at(bel.location.y * chip_info->width + bel.location.x);
+    }
+    void bindSliceTile(BelId bel, const CellInfo *cell);
+    void unbindSliceTile(BelId bel, const CellInfo *cell);
+    void rebuildSliceTile(BelId bel);
 
     void assignArchInfo();
 
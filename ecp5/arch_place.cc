@@ -21,6 +21,9 @@
 #include "log.h"
 #include "nextpnr.h"
 #include "util.h"
+
+#include <boost/range/iterator_range.hpp>
+
 NEXTPNR_NAMESPACE_BEGIN
 
 inline NetInfo *port_or_nullptr(const CellInfo *cell, IdString name)
@@ -31,14 +34,14 @@ inline NetInfo *port_or_nullptr(const CellInfo *cell, IdString name)
     return found->second.net;
 }
 
-bool Arch::slicesCompatible(const std::vector<const CellInfo *> &cells) const
+bool Arch::slicesCompatible(const CellInfo **it, const size_t size) const
 {
     // TODO: allow different LSR/CLK and MUX/SRMODE settings once
     // routing details are worked out
     IdString clk_sig, lsr_sig;
     IdString CLKMUX, LSRMUX, SRMODE;
     bool first = true;
-    for (auto cell : cells) {
+    for (auto cell : boost::make_iterator_range(it, it + size)) {
         if (cell->sliceInfo.using_dff) {
             if (first) {
                 clk_sig = cell->sliceInfo.clk_sig;
@@ -64,18 +67,56 @@ bool Arch::slicesCompatible(const std::vector<const CellInfo *> &cells) const
     return true;
 }
 
+static bool same_control_set(const Arch::SliceTileState &ts, const CellInfo *cell)
+{
+    return ts.clk_sig == cell->sliceInfo.clk_sig && ts.lsr_sig == cell->sliceInfo.lsr_sig &&
+           ts.clkmux == cell->sliceInfo.clkmux && ts.lsrmux == cell->sliceInfo.lsrmux &&
+           ts.srmode == cell->sliceInfo.srmode;
+}
+
+void Arch::bindSliceTile(BelId bel, const CellInfo *cell)
+{
+    if (!cell->sliceInfo.using_dff)
+        return;
+    SliceTileState &ts = getSliceTile(bel);
+    if (ts.dffs == 0) {
+        ts.clk_sig = cell->sliceInfo.clk_sig;
+        ts.lsr_sig = cell->sliceInfo.lsr_sig;
+        ts.clkmux = cell->sliceInfo.clkmux;
+        ts.lsrmux = cell->sliceInfo.lsrmux;
+        ts.srmode = cell->sliceInfo.srmode;
+    } else if (!same_control_set(ts, cell)) {
+        ts.conflict = true;
+    }
+    ts.dffs++;
+}
+
+void Arch::unbindSliceTile(BelId bel, const CellInfo *cell)
+{
+    if (!cell->sliceInfo.using_dff)
+        return;
+    SliceTileState &ts = getSliceTile(bel);
+    ts.dffs--;
+    // The remaining slices may now agree, which can only be found by looking at them all again
+    if (ts.conflict)
+        rebuildSliceTile(bel);
+}
+
+void Arch::rebuildSliceTile(BelId bel)
+{
+    Loc bel_loc = getBelLocation(bel);
+    getSliceTile(bel) = SliceTileState();
+    for (auto bel_other : getBelsByTile(bel_loc.x, bel_loc.y)) {
+        CellInfo *cell_other = getBoundBelCell(bel_other);
+        if (cell_other != nullptr && cell_other->type == id_TRELLIS_SLICE)
+            bindSliceTile(bel_other, cell_other);
+    }
+}
+
 bool Arch::isBelLocationValid(BelId bel) const
 {
     if (getBelType(bel) == id_TRELLIS_SLICE) {
-        std::vector<const CellInfo *> bel_cells;
-        Loc bel_loc = getBelLocation(bel);
-        for (auto bel_other : getBelsByTile(bel_loc.x, bel_loc.y)) {
-            CellInfo *cell_other = getBoundBelCell(bel_other);
-            if (cell_other != nullptr) {
-                bel_cells.push_back(cell_other);
-            }
-        }
-        return slicesCompatible(bel_cells);
+        return !getSliceTile(bel).conflict;
     } else {
         CellInfo *cell = getBoundBelCell(bel);
         if (cell == nullptr)
@@ -90,21 +131,50 @@ bool Arch::isValidBelForCell(CellInfo *cell, BelId bel) const
     if (cell->type == id_TRELLIS_SLICE) {
         NPNR_ASSERT(getBelType(bel) == id_TRELLIS_SLICE);
 
-        std::vector<const CellInfo *> bel_cells;
-        Loc bel_loc = getBelLocation(bel);
-        for (auto bel_other : getBelsByTile(bel_loc.x, bel_loc.y)) {
-            CellInfo *cell_other = getBoundBelCell(bel_other);
-            if (cell_other != nullptr && bel_other != bel) {
-                bel_cells.push_back(cell_other);
+        const SliceTileState &ts = getSliceTile(bel);
+        const CellInfo *bound = getBoundBelCell(bel);
+        if (bound == cell)
+            return !ts.conflict;
+
+        if (ts.conflict) {
+            // Replacing the bound slice might resolve the conflict, so check the tile slice by slice
+            std::array<const CellInfo *, 4> bel_cells;
+            size_t num_cells = 0;
+            Loc bel_loc = getBelLocation(bel);
+            for (auto bel_other : getBelsByTile(bel_loc.x, bel_loc.y)) {
+                CellInfo *cell_other = getBoundBelCell(bel_other);
+                if (cell_other != nullptr && cell_other->type == id_TRELLIS_SLICE && bel_other != bel) {
+                    NPNR_ASSERT(num_cells < bel_cells.size() - 1);
+                    bel_cells[num_cells++] = cell_other;
+                }
             }
+            bel_cells[num_cells++] = cell;
+            return slicesCompatible(bel_cells.data(), num_cells);
         }
 
-        bel_cells.push_back(cell);
-        return slicesCompatible(bel_cells);
+        if (!cell->sliceInfo.using_dff)
+            return true;
+        int dffs = ts.dffs;
+        if (bound != nullptr && bound->sliceInfo.using_dff)
+            dffs--;
+        return dffs == 0 || same_control_set(ts, cell);
     } else {
         // other checks
         return true;
     }
 }
 
+bool Arch::isValidBelForCell(CellInfo *cell, BelId bel, CellInfo *replaced) const
+{
+    NPNR_ASSERT(getBoundBelCell(bel) == replaced);
+    if (cell->type == id_TRELLIS_SLICE && cell->bel != BelId()) {
+        Loc bel_loc = getBelLocation(bel), cell_loc = getBelLocation(cell->bel);
+        // Moving slices around within a tile leaves the slices in it, and so
+        // the tile state, the same
+        if (bel_loc.x == cell_loc.x && bel_loc.y == cell_loc.y)
+            return !getSliceTile(bel).conflict;
+    }
+    return isValidBelForCell(cell, bel);
+}
+
 NEXTPNR_NAMESPACE_END
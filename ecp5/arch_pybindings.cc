@@ -44,7 +44,8 @@ void arch_wrap_python()
                            .def("checksum", &Context::checksum)
                            .def("pack", &Context::pack)
                            .def("place", &Context::place)
-                           .def("route", &Context::route);
+                           .def("route", &Context::route)
+                           .def("clone", clone_context_shim, return_value_policy<manage_new_object>());
 
     fn_wrapper_1a<Context, decltype(&Context::getBelType), &Context::getBelType, conv_to_str<IdString>,
                   conv_from_str<BelId>>::def_wrap(ctx_cls, "getBelType");
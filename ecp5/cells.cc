@@ -162,22 +162,25 @@ static void set_param_safe(bool has_ff, CellInfo *lc, IdString name, const std::
     lc->params[name] = value;
 }
 
-static void replace_port_safe(bool has_ff, CellInfo *ff, IdString ff_port, CellInfo *lc, IdString lc_port)
+static void replace_port_safe(bool has_ff, CellInfo *ff, IdString ff_port, CellInfo *lc, IdString lc_port,
+                              NetlistTransaction *tx)
 {
     if (has_ff) {
         NPNR_ASSERT(lc->ports.at(lc_port).net == ff->ports.at(ff_port).net);
         NetInfo *ffnet = ff->ports.at(ff_port).net;
-        if (ffnet != nullptr)
+        if (ffnet != nullptr && tx != nullptr)
+            tx->remove_user(ffnet, ff, ff_port);
+        else if (ffnet != nullptr)
             ffnet->users.erase(
                     std::remove_if(ffnet->users.begin(), ffnet->users.end(),
                                    [ff, ff_port](PortRef port) { return port.cell == ff && port.port == ff_port; }),
                     ffnet->users.end());
     } else {
-        replace_port(ff, ff_port, lc, lc_port);
+        replace_port(ff, ff_port, lc, lc_port, tx);
     }
 }
 
-void ff_to_slice(Context *ctx, CellInfo *ff, CellInfo *lc, int index, bool driven_by_lut)
+void ff_to_slice(Context *ctx, CellInfo *ff, CellInfo *lc, int index, bool driven_by_lut, NetlistTransaction *tx)
 {
     bool has_ff = lc->ports.at(ctx->id("Q0")).net != nullptr || lc->ports.at(ctx->id("Q1")).net != nullptr;
     std::string reg = "REG" + std::to_string(index);
@@ -189,31 +192,31 @@ void ff_to_slice(Context *ctx, CellInfo *ff, CellInfo *lc, int index, bool drive
 
     lc->params[ctx->id(reg + "_SD")] = driven_by_lut ? "1" : "0";
     lc->params[ctx->id(reg + "_REGSET")] = str_or_default(ff->params, ctx->id("REGSET"), "RESET");
-    replace_port_safe(has_ff, ff, ctx->id("CLK"), lc, ctx->id("CLK"));
+    replace_port_safe(has_ff, ff, ctx->id("CLK"), lc, ctx->id("CLK"), tx);
     if (ff->ports.find(ctx->id("LSR")) != ff->ports.end())
-        replace_port_safe(has_ff, ff, ctx->id("LSR"), lc, ctx->id("LSR"));
+        replace_port_safe(has_ff, ff, ctx->id("LSR"), lc, ctx->id("LSR"), tx);
     if (ff->ports.find(ctx->id("CE")) != ff->ports.end())
-        replace_port_safe(has_ff, ff, ctx->id("CE"), lc, ctx->id("CE"));
+        replace_port_safe(has_ff, ff, ctx->id("CE"), lc, ctx->id("CE"), tx);
 
-    replace_port(ff, ctx->id("Q"), lc, ctx->id("Q" + std::to_string(index)));
+    replace_port(ff, ctx->id("Q"), lc, ctx->id("Q" + std::to_string(index)), tx);
     if (driven_by_lut) {
-        replace_port(ff, ctx->id("DI"), lc, ctx->id("DI" + std::to_string(index)));
+        replace_port(ff, ctx->id("DI"), lc, ctx->id("DI" + std::to_string(index)), tx);
     } else {
-        replace_port(ff, ctx->id("DI"), lc, ctx->id("M" + std::to_string(index)));
+        replace_port(ff, ctx->id("DI"), lc, ctx->id("M" + std::to_string(index)), tx);
     }
 }
 
-void lut_to_slice(Context *ctx, CellInfo *lut, CellInfo *lc, int index)
+void lut_to_slice(Context *ctx, CellInfo *lut, CellInfo *lc, int index, NetlistTransaction *tx)
 {
     lc->params[ctx->id("LUT" + std::to_string(index) + "_INITVAL")] = str_or_default(lut->params, ctx->id("INIT"), "0");
-    replace_port(lut, ctx->id("A"), lc, ctx->id("A" + std::to_string(index)));
-    replace_port(lut, ctx->id("B"), lc, ctx->id("B" + std::to_string(index)));
-    replace_port(lut, ctx->id("C"), lc, ctx->id("C" + std::to_string(index)));
-    replace_port(lut, ctx->id("D"), lc, ctx->id("D" + std::to_string(index)));
-    replace_port(lut, ctx->id("Z"), lc, ctx->id("F" + std::to_string(index)));
+    replace_port(lut, ctx->id("A"), lc, ctx->id("A" + std::to_string(index)), tx);
+    replace_port(lut, ctx->id("B"), lc, ctx->id("B" + std::to_string(index)), tx);
+    replace_port(lut, ctx->id("C"), lc, ctx->id("C" + std::to_string(index)), tx);
+    replace_port(lut, ctx->id("D"), lc, ctx->id("D" + std::to_string(index)), tx);
+    replace_port(lut, ctx->id("Z"), lc, ctx->id("F" + std::to_string(index)), tx);
 }
 
-void ccu2c_to_slice(Context *ctx, CellInfo *ccu, CellInfo *lc)
+void ccu2c_to_slice(Context *ctx, CellInfo *ccu, CellInfo *lc, NetlistTransaction *tx)
 {
     lc->params[ctx->id("MODE")] = "CCU2";
     lc->params[ctx->id("LUT0_INITVAL")] = str_or_default(ccu->params, ctx->id("INIT0"), "0");
@@ -222,36 +225,36 @@ void ccu2c_to_slice(Context *ctx, CellInfo *ccu, CellInfo *lc)
     lc->params[ctx->id("INJECT1_0")] = str_or_default(ccu->params, ctx->id("INJECT1_0"), "YES");
     lc->params[ctx->id("INJECT1_1")] = str_or_default(ccu->params, ctx->id("INJECT1_1"), "YES");
 
-    replace_port(ccu, ctx->id("CIN"), lc, ctx->id("FCI"));
+    replace_port(ccu, ctx->id("CIN"), lc, ctx->id("FCI"), tx);
 
-    replace_port(ccu, ctx->id("A0"), lc, ctx->id("A0"));
-    replace_port(ccu, ctx->id("B0"), lc, ctx->id("B0"));
-    replace_port(ccu, ctx->id("C0"), lc, ctx->id("C0"));
-    replace_port(ccu, ctx->id("D0"), lc, ctx->id("D0"));
+    replace_port(ccu, ctx->id("A0"), lc, ctx->id("A0"), tx);
+    replace_port(ccu, ctx->id("B0"), lc, ctx->id("B0"), tx);
+    replace_port(ccu, ctx->id("C0"), lc, ctx->id("C0"), tx);
+    replace_port(ccu, ctx->id("D0"), lc, ctx->id("D0"), tx);
 
-    replace_port(ccu, ctx->id("A1"), lc, ctx->id("A1"));
-    replace_port(ccu, ctx->id("B1"), lc, ctx->id("B1"));
-    replace_port(ccu, ctx->id("C1"), lc, ctx->id("C1"));
-    replace_port(ccu, ctx->id("D1"), lc, ctx->id("D1"));
+    replace_port(ccu, ctx->id("A1"), lc, ctx->id("A1"), tx);
+    replace_port(ccu, ctx->id("B1"), lc, ctx->id("B1"), tx);
+    replace_port(ccu, ctx->id("C1"), lc, ctx->id("C1"), tx);
+    replace_port(ccu, ctx->id("D1"), lc, ctx->id("D1"), tx);
 
-    replace_port(ccu, ctx->id("S0"), lc, ctx->id("F0"));
-    replace_port(ccu, ctx->id("S1"), lc, ctx->id("F1"));
+    replace_port(ccu, ctx->id("S0"), lc, ctx->id("F0"), tx);
+    replace_port(ccu, ctx->id("S1"), lc, ctx->id("F1"), tx);
 
-    replace_port(ccu, ctx->id("COUT"), lc, ctx->id("FCO"));
+    replace_port(ccu, ctx->id("COUT"), lc, ctx->id("FCO"), tx);
 }
 
-void dram_to_ramw(Context *ctx, CellInfo *ram, CellInfo *lc)
+void dram_to_ramw(Context *ctx, CellInfo *ram, CellInfo *lc, NetlistTransaction *tx)
 {
     lc->params[ctx->id("MODE")] = "RAMW";
-    replace_port(ram, ctx->id("WAD[0]"), lc, ctx->id("D0"));
-    replace_port(ram, ctx->id("WAD[1]"), lc, ctx->id("B0"));
-    replace_port(ram, ctx->id("WAD[2]"), lc, ctx->id("C0"));
-    replace_port(ram, ctx->id("WAD[3]"), lc, ctx->id("A0"));
-
-    replace_port(ram, ctx->id("DI[0]"), lc, ctx->id("C1"));
-    replace_port(ram, ctx->id("DI[1]"), lc, ctx->id("A1"));
-    replace_port(ram, ctx->id("DI[2]"), lc, ctx->id("D1"));
-    replace_port(ram, ctx->id("DI[3]"), lc, ctx->id("B1"));
+    replace_port(ram, ctx->id("WAD[0]"), lc, ctx->id("D0"), tx);
+    replace_port(ram, ctx->id("WAD[1]"), lc, ctx->id("B0"), tx);
+    replace_port(ram, ctx->id("WAD[2]"), lc, ctx->id("C0"), tx);
+    replace_port(ram, ctx->id("WAD[3]"), lc, ctx->id("A0"), tx);
+
+    replace_port(ram, ctx->id("DI[0]"), lc, ctx->id("C1"), tx);
+    replace_port(ram, ctx->id("DI[1]"), lc, ctx->id("A1"), tx);
+    replace_port(ram, ctx->id("DI[2]"), lc, ctx->id("D1"), tx);
+    replace_port(ram, ctx->id("DI[3]"), lc, ctx->id("B1"), tx);
 }
 
 static unsigned get_dram_init(const Context *ctx, const CellInfo *ram, int bit)
@@ -270,7 +273,7 @@ static unsigned get_dram_init(const Context *ctx, const CellInfo *ram, int bit)
     return value;
 }
 
-void dram_to_ram_slice(Context *ctx, CellInfo *ram, CellInfo *lc, CellInfo *ramw, int index)
+void dram_to_ram_slice(Context *ctx, CellInfo *ram, CellInfo *lc, CellInfo *ramw, int index, NetlistTransaction *tx)
 {
     lc->params[ctx->id("MODE")] = "DPRAM";
     lc->params[ctx->id("WREMUX")] = str_or_default(ram->params, ctx->id("WREMUX"), "WRE");
@@ -299,45 +302,45 @@ void dram_to_ram_slice(Context *ctx, CellInfo *ram, CellInfo *lc, CellInfo *ramw
     lc->params[ctx->id("LUT1_INITVAL")] = std::to_string(permuted_init1);
 
     if (ram->ports.count(ctx->id("RAD[0]"))) {
-        connect_port(ctx, ram->ports.at(ctx->id("RAD[0]")).net, lc, ctx->id("D0"));
-        connect_port(ctx, ram->ports.at(ctx->id("RAD[0]")).net, lc, ctx->id("D1"));
+        connect_port(ctx, ram->ports.at(ctx->id("RAD[0]")).net, lc, ctx->id("D0"), tx);
+        connect_port(ctx, ram->ports.at(ctx->id("RAD[0]")).net, lc, ctx->id("D1"), tx);
     }
     if (ram->ports.count(ctx->id("RAD[1]"))) {
-        connect_port(ctx, ram->ports.at(ctx->id("RAD[1]")).net, lc, ctx->id("B0"));
-        connect_port(ctx, ram->ports.at(ctx->id("RAD[1]")).net, lc, ctx->id("B1"));
+        connect_port(ctx, ram->ports.at(ctx->id("RAD[1]")).net, lc, ctx->id("B0"), tx);
+        connect_port(ctx, ram->ports.at(ctx->id("RAD[1]")).net, lc, ctx->id("B1"), tx);
     }
     if (ram->ports.count(ctx->id("RAD[2]"))) {
-        connect_port(ctx, ram->ports.at(ctx->id("RAD[2]")).net, lc, ctx->id("C0"));
-        connect_port(ctx, ram->ports.at(ctx->id("RAD[2]")).net, lc, ctx->id("C1"));
+        connect_port(ctx, ram->ports.at(ctx->id("RAD[2]")).net, lc, ctx->id("C0"), tx);
+        connect_port(ctx, ram->ports.at(ctx->id("RAD[2]")).net, lc, ctx->id("C1"), tx);
     }
     if (ram->ports.count(ctx->id("RAD[3]"))) {
-        connect_port(ctx, ram->ports.at(ctx->id("RAD[3]")).net, lc, ctx->id("A0"));
-        connect_port(ctx, ram->ports.at(ctx->id("RAD[3]")).net, lc, ctx->id("A1"));
+        connect_port(ctx, ram->ports.at(ctx->id("RAD[3]")).net, lc, ctx->id("A0"), tx);
+        connect_port(ctx, ram->ports.at(ctx->id("RAD[3]")).net, lc, ctx->id("A1"), tx);
     }
 
     if (ram->ports.count(ctx->id("WRE")))
-        connect_port(ctx, ram->ports.at(ctx->id("WRE")).net, lc, ctx->id("WRE"));
+        connect_port(ctx, ram->ports.at(ctx->id("WRE")).net, lc, ctx->id("WRE"), tx);
     if (ram->ports.count(ctx->id("WCK")))
-        connect_port(ctx, ram->ports.at(ctx->id("WCK")).net, lc, ctx->id("WCK"));
+        connect_port(ctx, ram->ports.at(ctx->id("WCK")).net, lc, ctx->id("WCK"), tx);
 
-    connect_ports(ctx, ramw, id_WADO0, lc, id_WAD0);
-    connect_ports(ctx, ramw, id_WADO1, lc, id_WAD1);
-    connect_ports(ctx, ramw, id_WADO2, lc, id_WAD2);
-    connect_ports(ctx, ramw, id_WADO3, lc, id_WAD3);
+    connect_ports(ctx, ramw, id_WADO0, lc, id_WAD0, tx);
+    connect_ports(ctx, ramw, id_WADO1, lc, id_WAD1, tx);
+    connect_ports(ctx, ramw, id_WADO2, lc, id_WAD2, tx);
+    connect_ports(ctx, ramw, id_WADO3, lc, id_WAD3, tx);
 
     if (index == 0) {
-        connect_ports(ctx, ramw, id_WDO0, lc, id_WD0);
-        connect_ports(ctx, ramw, id_WDO1, lc, id_WD1);
+        connect_ports(ctx, ramw, id_WDO0, lc, id_WD0, tx);
+        connect_ports(ctx, ramw, id_WDO1, lc, id_WD1, tx);
 
-        replace_port(ram, ctx->id("DO[0]"), lc, id_F0);
-        replace_port(ram, ctx->id("DO[1]"), lc, id_F1);
+        replace_port(ram, ctx->id("DO[0]"), lc, id_F0, tx);
+        replace_port(ram, ctx->id("DO[1]"), lc, id_F1, tx);
 
     } else if (index == 1) {
-        connect_ports(ctx, ramw, id_WDO2, lc, id_WD0);
-        connect_ports(ctx, ramw, id_WDO3, lc, id_WD1);
+        connect_ports(ctx, ramw, id_WDO2, lc, id_WD0, tx);
+        connect_ports(ctx, ramw, id_WDO3, lc, id_WD1, tx);
 
-        replace_port(ram, ctx->id("DO[2]"), lc, id_F0);
-        replace_port(ram, ctx->id("DO[3]"), lc, id_F1);
+        replace_port(ram, ctx->id("DO[2]"), lc, id_F0, tx);
+        replace_port(ram, ctx->id("DO[3]"), lc, id_F1, tx);
     } else {
         NPNR_ASSERT_FALSE("bad DPRAM index");
     }
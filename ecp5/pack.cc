@@ -26,6 +26,7 @@
 #include "design_utils.h"
 #include "globals.h"
 #include "log.h"
+#include "settings.h"
 #include "util.h"
 NEXTPNR_NAMESPACE_BEGIN
 
@@ -38,37 +39,52 @@ static bool is_nextpnr_iob(Context *ctx, CellInfo *cell)
 class Ecp5Packer
 {
   public:
-    Ecp5Packer(Context *ctx) : ctx(ctx){};
+    Ecp5Packer(Context *ctx)
+            : ctx(ctx), parallel_chunk(std::max(1, Settings(ctx).get<int>("pack/parallelChunk", 1024))), tx(ctx){};
 
   private:
-    // Process the contents of packed_cells and new_cells
+    // Process the contents of packed_cells and new_cells, and any rewiring
+    // staged in tx, in one pass
     void flush_cells()
     {
         for (auto pcell : packed_cells) {
-            ctx->cells.erase(pcell);
+            tx.remove_cell(pcell);
         }
         for (auto &ncell : new_cells) {
-            ctx->cells[ncell->name] = std::move(ncell);
+            tx.add_cell(std::move(ncell));
         }
         packed_cells.clear();
         new_cells.clear();
+        tx.commit();
     }
 
     // Find FFs associated with LUTs, or LUT expansion muxes
     void find_lutff_pairs()
     {
         log_info("Finding LUTFF pairs...\n");
-        for (auto cell : sorted(ctx->cells)) {
-            CellInfo *ci = cell.second;
-            if (is_lut(ctx, ci) || is_pfumx(ctx, ci) || is_l6mux(ctx, ci)) {
-                NetInfo *znet = ci->ports.at(ctx->id("Z")).net;
-                if (znet != nullptr) {
-                    CellInfo *ff = net_only_drives(ctx, znet, is_ff, ctx->id("DI"), false);
-                    if (ff != nullptr) {
-                        lutffPairs[ci->name] = ff->name;
-                        fflutPairs[ff->name] = ci->name;
+        std::vector<CellInfo *> cells;
+        for (auto cell : sorted(ctx->cells))
+            cells.push_back(cell.second);
+        // Each LUT's FF is found independently, so search in parallel and then record the pairs in name order
+        std::vector<CellInfo *> ffs(cells.size(), nullptr);
+        parallel_for_chunks(
+                cells.size(),
+                [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; i++) {
+                        CellInfo *ci = cells.at(i);
+                        if (is_lut(ctx, ci) || is_pfumx(ctx, ci) || is_l6mux(ctx, ci)) {
+                            NetInfo *znet = ci->ports.at(id_Z).net;
+                            if (znet != nullptr)
+                                ffs.at(i) = net_only_drives(ctx, znet, is_ff, id_DI, false);
+                        }
                     }
-                }
+                },
+                parallel_chunk);
+        for (size_t i = 0; i < cells.size(); i++) {
+            CellInfo *ff = ffs.at(i);
+            if (ff != nullptr) {
+                lutffPairs[cells.at(i)->name] = ff->name;
+                fflutPairs[ff->name] = cells.at(i)->name;
             }
         }
     }
@@ -85,25 +101,22 @@ class Ecp5Packer
     // Return whether two FFs can be packed together in the same slice
     bool can_pack_ffs(CellInfo *ff0, CellInfo *ff1)
     {
-        if (str_or_default(ff0->params, ctx->id("GSR"), "DISABLED") !=
-            str_or_default(ff1->params, ctx->id("GSR"), "DISABLED"))
+        if (str_or_default(ff0->params, id_GSR, "DISABLED") != str_or_default(ff1->params, id_GSR, "DISABLED"))
             return false;
-        if (str_or_default(ff0->params, ctx->id("SRMODE"), "LSR_OVER_CE") !=
-            str_or_default(ff1->params, ctx->id("SRMODE"), "LSR_OVER_CE"))
+        if (str_or_default(ff0->params, id_SRMODE, "LSR_OVER_CE") !=
+            str_or_default(ff1->params, id_SRMODE, "LSR_OVER_CE"))
             return false;
-        if (str_or_default(ff0->params, ctx->id("CEMUX"), "1") != str_or_default(ff1->params, ctx->id("CEMUX"), "1"))
+        if (str_or_default(ff0->params, id_CEMUX, "1") != str_or_default(ff1->params, id_CEMUX, "1"))
             return false;
-        if (str_or_default(ff0->params, ctx->id("LSRMUX"), "LSR") !=
-            str_or_default(ff1->params, ctx->id("LSRMUX"), "LSR"))
+        if (str_or_default(ff0->params, id_LSRMUX, "LSR") != str_or_default(ff1->params, id_LSRMUX, "LSR"))
             return false;
-        if (str_or_default(ff0->params, ctx->id("CLKMUX"), "CLK") !=
-            str_or_default(ff1->params, ctx->id("CLKMUX"), "CLK"))
+        if (str_or_default(ff0->params, id_CLKMUX, "CLK") != str_or_default(ff1->params, id_CLKMUX, "CLK"))
             return false;
-        if (net_or_nullptr(ff0, ctx->id("CLK")) != net_or_nullptr(ff1, ctx->id("CLK")))
+        if (net_or_nullptr(ff0, id_CLK) != net_or_nullptr(ff1, id_CLK))
             return false;
-        if (net_or_nullptr(ff0, ctx->id("CE")) != net_or_nullptr(ff1, ctx->id("CE")))
+        if (net_or_nullptr(ff0, id_CE) != net_or_nullptr(ff1, id_CE))
             return false;
-        if (net_or_nullptr(ff0, ctx->id("LSR")) != net_or_nullptr(ff1, ctx->id("LSR")))
+        if (net_or_nullptr(ff0, id_LSR) != net_or_nullptr(ff1, id_LSR))
             return false;
         return true;
     }
@@ -112,18 +125,16 @@ class Ecp5Packer
     bool can_add_ff_to_tile(const std::vector<CellInfo *> &tile_ffs, CellInfo *ff0)
     {
         for (const auto &existing : tile_ffs) {
-            if (net_or_nullptr(existing, ctx->id("CLK")) != net_or_nullptr(ff0, ctx->id("CLK")))
+            if (net_or_nullptr(existing, id_CLK) != net_or_nullptr(ff0, id_CLK))
                 return false;
-            if (net_or_nullptr(existing, ctx->id("LSR")) != net_or_nullptr(ff0, ctx->id("LSR")))
+            if (net_or_nullptr(existing, id_LSR) != net_or_nullptr(ff0, id_LSR))
                 return false;
-            if (str_or_default(existing->params, ctx->id("CLKMUX"), "CLK") !=
-                str_or_default(ff0->params, ctx->id("CLKMUX"), "CLK"))
+            if (str_or_default(existing->params, id_CLKMUX, "CLK") != str_or_default(ff0->params, id_CLKMUX, "CLK"))
                 return false;
-            if (str_or_default(existing->params, ctx->id("LSRMUX"), "LSR") !=
-                str_or_default(ff0->params, ctx->id("LSRMUX"), "LSR"))
+            if (str_or_default(existing->params, id_LSRMUX, "LSR") != str_or_default(ff0->params, id_LSRMUX, "LSR"))
                 return false;
-            if (str_or_default(existing->params, ctx->id("SRMODE"), "LSR_OVER_CE") !=
-                str_or_default(ff0->params, ctx->id("SRMODE"), "LSR_OVER_CE"))
+            if (str_or_default(existing->params, id_SRMODE, "LSR_OVER_CE") !=
+                str_or_default(ff0->params, id_SRMODE, "LSR_OVER_CE"))
                 return false;
         }
         return true;
@@ -154,83 +165,72 @@ class Ecp5Packer
         }
     }
 
+    // Find the LUTs that could share a slice with a given LUT, in order of preference: LUTs driven by it, LUTs
+    // driven by its paired FF, then LUTs (or the LUTs of FFs) driving its inputs
+    void find_lut_pair_candidates(const CellInfo *ci, std::vector<IdString> &candidates)
+    {
+        NetInfo *znet = ci->ports.at(id_Z).net;
+        if (znet != nullptr) {
+            for (auto &user : znet->users)
+                if (is_lut(ctx, user.cell) && user.cell != ci && can_pack_lutff(ci->name, user.cell->name))
+                    candidates.push_back(user.cell->name);
+        }
+        auto ff = lutffPairs.find(ci->name);
+        if (ff != lutffPairs.end()) {
+            NetInfo *qnet = ctx->cells.at(ff->second)->ports.at(id_Q).net;
+            if (qnet != nullptr) {
+                for (auto &user : qnet->users)
+                    if (is_lut(ctx, user.cell) && user.cell != ci && can_pack_lutff(ci->name, user.cell->name))
+                        candidates.push_back(user.cell->name);
+            }
+        }
+        for (IdString inp : {id_A, id_B, id_C, id_D}) {
+            NetInfo *innet = ci->ports.at(inp).net;
+            if (innet != nullptr && innet->driver.cell != nullptr) {
+                CellInfo *drv = innet->driver.cell;
+                if (is_lut(ctx, drv) && drv != ci && innet->driver.port == id_Z) {
+                    if (can_pack_lutff(ci->name, drv->name))
+                        candidates.push_back(drv->name);
+                } else if (is_ff(ctx, drv) && innet->driver.port == id_Q) {
+                    auto fflut = fflutPairs.find(drv->name);
+                    if (fflut != fflutPairs.end() && fflut->second != ci->name &&
+                        can_pack_lutff(ci->name, fflut->second))
+                        candidates.push_back(fflut->second);
+                }
+            }
+        }
+    }
+
     // Find "closely connected" LUTs and pair them together
     void pair_luts()
     {
         log_info("Finding LUT-LUT pairs...\n");
+        std::vector<CellInfo *> luts;
+        for (auto cell : sorted(ctx->cells))
+            if (is_lut(ctx, cell.second))
+                luts.push_back(cell.second);
+        // Candidate discovery (including the FF compatibility checks) only reads the netlist, so it is done in
+        // parallel. Pairs are then committed greedily in LUT name order, giving the same result on any thread count.
+        std::vector<std::vector<IdString>> candidates(luts.size());
+        parallel_for_chunks(
+                luts.size(),
+                [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; i++)
+                        find_lut_pair_candidates(luts.at(i), candidates.at(i));
+                },
+                parallel_chunk);
         std::unordered_set<IdString> procdLuts;
-        for (auto cell : sorted(ctx->cells)) {
-            CellInfo *ci = cell.second;
-            if (is_lut(ctx, ci) && procdLuts.find(cell.first) == procdLuts.end()) {
-                NetInfo *znet = ci->ports.at(ctx->id("Z")).net;
-                if (znet != nullptr) {
-                    for (auto user : znet->users) {
-                        if (is_lut(ctx, user.cell) && user.cell != ci &&
-                            procdLuts.find(user.cell->name) == procdLuts.end()) {
-                            if (can_pack_lutff(ci->name, user.cell->name)) {
-                                procdLuts.insert(ci->name);
-                                procdLuts.insert(user.cell->name);
-                                lutPairs[ci->name] = user.cell->name;
-                                goto paired;
-                            }
-                        }
-                    }
-                    if (false) {
-                    paired:
-                        continue;
-                    }
-                }
-                if (lutffPairs.find(ci->name) != lutffPairs.end()) {
-                    NetInfo *qnet = ctx->cells.at(lutffPairs[ci->name])->ports.at(ctx->id("Q")).net;
-                    if (qnet != nullptr) {
-                        for (auto user : qnet->users) {
-                            if (is_lut(ctx, user.cell) && user.cell != ci &&
-                                procdLuts.find(user.cell->name) == procdLuts.end()) {
-                                if (can_pack_lutff(ci->name, user.cell->name)) {
-                                    procdLuts.insert(ci->name);
-                                    procdLuts.insert(user.cell->name);
-                                    lutPairs[ci->name] = user.cell->name;
-                                    goto paired_ff;
-                                }
-                            }
-                        }
-                        if (false) {
-                        paired_ff:
-                            continue;
-                        }
-                    }
-                }
-                for (const char *inp : {"A", "B", "C", "D"}) {
-                    NetInfo *innet = ci->ports.at(ctx->id(inp)).net;
-                    if (innet != nullptr && innet->driver.cell != nullptr) {
-                        CellInfo *drv = innet->driver.cell;
-                        if (is_lut(ctx, drv) && drv != ci && innet->driver.port == ctx->id("Z")) {
-                            if (procdLuts.find(drv->name) == procdLuts.end()) {
-                                if (can_pack_lutff(ci->name, drv->name)) {
-                                    procdLuts.insert(ci->name);
-                                    procdLuts.insert(drv->name);
-                                    lutPairs[ci->name] = drv->name;
-                                    goto paired_inlut;
-                                }
-                            }
-                        } else if (is_ff(ctx, drv) && innet->driver.port == ctx->id("Q")) {
-                            auto fflut = fflutPairs.find(drv->name);
-                            if (fflut != fflutPairs.end() && fflut->second != ci->name &&
-                                procdLuts.find(fflut->second) == procdLuts.end()) {
-                                if (can_pack_lutff(ci->name, fflut->second)) {
-                                    procdLuts.insert(ci->name);
-                                    procdLuts.insert(fflut->second);
-                                    lutPairs[ci->name] = fflut->second;
-                                    goto paired_inlut;
-                                }
-                            }
-                        }
-                    }
-                }
-                if (false) {
-                paired_inlut:
+        for (size_t i = 0; i < luts.size(); i++) {
+            CellInfo *ci = luts.at(i);
+            if (procdLuts.count(ci->name))
+                continue;
+            for (auto cand : candidates.at(i)) {
+                if (procdLuts.count(cand))
                     continue;
-                }
+                procdLuts.insert(ci->name);
+                procdLuts.insert(cand);
+                lutPairs[ci->name] = cand;
+                break;
             }
         }
     }
@@ -318,16 +318,16 @@ class Ecp5Packer
                     log_error("PFUMX '%s' has BLUT driven by cell other than a LUT\n", ci->name.c_str(ctx));
                 if (lut1 == nullptr)
                     log_error("PFUMX '%s' has ALUT driven by cell other than a LUT\n", ci->name.c_str(ctx));
-                replace_port(lut0, ctx->id("A"), packed.get(), ctx->id("A0"));
-                replace_port(lut0, ctx->id("B"), packed.get(), ctx->id("B0"));
-                replace_port(lut0, ctx->id("C"), packed.get(), ctx->id("C0"));
-                replace_port(lut0, ctx->id("D"), packed.get(), ctx->id("D0"));
-                replace_port(lut1, ctx->id("A"), packed.get(), ctx->id("A1"));
-                replace_port(lut1, ctx->id("B"), packed.get(), ctx->id("B1"));
-                replace_port(lut1, ctx->id("C"), packed.get(), ctx->id("C1"));
-                replace_port(lut1, ctx->id("D"), packed.get(), ctx->id("D1"));
-                replace_port(ci, ctx->id("C0"), packed.get(), ctx->id("M0"));
-                replace_port(ci, ctx->id("Z"), packed.get(), ctx->id("OFX0"));
+                replace_port(lut0, ctx->id("A"), packed.get(), ctx->id("A0"), &tx);
+                replace_port(lut0, ctx->id("B"), packed.get(), ctx->id("B0"), &tx);
+                replace_port(lut0, ctx->id("C"), packed.get(), ctx->id("C0"), &tx);
+                replace_port(lut0, ctx->id("D"), packed.get(), ctx->id("D0"), &tx);
+                replace_port(lut1, ctx->id("A"), packed.get(), ctx->id("A1"), &tx);
+                replace_port(lut1, ctx->id("B"), packed.get(), ctx->id("B1"), &tx);
+                replace_port(lut1, ctx->id("C"), packed.get(), ctx->id("C1"), &tx);
+                replace_port(lut1, ctx->id("D"), packed.get(), ctx->id("D1"), &tx);
+                replace_port(ci, ctx->id("C0"), packed.get(), ctx->id("M0"), &tx);
+                replace_port(ci, ctx->id("Z"), packed.get(), ctx->id("OFX0"), &tx);
                 packed->params[ctx->id("LUT0_INITVAL")] = str_or_default(lut0->params, ctx->id("INIT"), "0");
                 packed->params[ctx->id("LUT1_INITVAL")] = str_or_default(lut1->params, ctx->id("INIT"), "0");
 
@@ -339,7 +339,7 @@ class Ecp5Packer
 
                 if (lutffPairs.find(ci->name) != lutffPairs.end()) {
                     CellInfo *ff = ctx->cells.at(lutffPairs[ci->name]).get();
-                    ff_to_slice(ctx, ff, packed.get(), 0, true);
+                    ff_to_slice(ctx, ff, packed.get(), 0, true, &tx);
                     packed_cells.insert(ff->name);
                     sliceUsage[packed->name].ff0_used = true;
                     lutffPairs.erase(ci->name);
@@ -436,9 +436,11 @@ class Ecp5Packer
         return feedout_ptr;
     }
 
-    // Split a carry chain into multiple legal chains
+    // Split a carry chain into multiple legal chains. The feed ins and feed
+    // outs rewire user lists directly, so no change may be pending in tx.
     std::vector<CellChain> split_carry_chain(CellChain &carryc)
     {
+        NPNR_ASSERT(tx.empty());
         bool start_of_chain = true;
         std::vector<CellChain> chains;
         const int max_length = (ctx->chip_info->width - 4) * 4 - 2;
@@ -528,7 +530,7 @@ class Ecp5Packer
                 std::unique_ptr<CellInfo> slice =
                         create_ecp5_cell(ctx, ctx->id("TRELLIS_SLICE"), cell->name.str(ctx) + "$CCU2_SLICE");
 
-                ccu2c_to_slice(ctx, cell, slice.get());
+                ccu2c_to_slice(ctx, cell, slice.get(), &tx);
 
                 CellInfo *ff0 = nullptr;
                 NetInfo *f0net = slice->ports.at(ctx->id("F0")).net;
@@ -561,7 +563,7 @@ class Ecp5Packer
         }
 
         for (auto ff : ff_packing)
-            ff_to_slice(ctx, std::get<0>(ff), std::get<1>(ff), std::get<2>(ff), true);
+            ff_to_slice(ctx, std::get<0>(ff), std::get<1>(ff), std::get<2>(ff), true, &tx);
 
         // Relative chain placement
         for (auto &chain : packed_chains) {
@@ -590,25 +592,25 @@ class Ecp5Packer
                 // Create RAMW slice
                 std::unique_ptr<CellInfo> ramw_slice =
                         create_ecp5_cell(ctx, ctx->id("TRELLIS_SLICE"), ci->name.str(ctx) + "$RAMW_SLICE");
-                dram_to_ramw(ctx, ci, ramw_slice.get());
+                dram_to_ramw(ctx, ci, ramw_slice.get(), &tx);
 
                 // Create actual RAM slices
                 std::unique_ptr<CellInfo> ram0_slice =
                         create_ecp5_cell(ctx, ctx->id("TRELLIS_SLICE"), ci->name.str(ctx) + "$DPRAM0_SLICE");
-                dram_to_ram_slice(ctx, ci, ram0_slice.get(), ramw_slice.get(), 0);
+                dram_to_ram_slice(ctx, ci, ram0_slice.get(), ramw_slice.get(), 0, &tx);
 
                 std::unique_ptr<CellInfo> ram1_slice =
                         create_ecp5_cell(ctx, ctx->id("TRELLIS_SLICE"), ci->name.str(ctx) + "$DPRAM1_SLICE");
-                dram_to_ram_slice(ctx, ci, ram1_slice.get(), ramw_slice.get(), 1);
+                dram_to_ram_slice(ctx, ci, ram1_slice.get(), ramw_slice.get(), 1, &tx);
 
                 // Disconnect ports of original cell after packing
-                disconnect_port(ctx, ci, id_WCK);
-                disconnect_port(ctx, ci, id_WRE);
+                disconnect_port(ctx, ci, id_WCK, &tx);
+                disconnect_port(ctx, ci, id_WRE, &tx);
 
-                disconnect_port(ctx, ci, ctx->id("RAD[0]"));
-                disconnect_port(ctx, ci, ctx->id("RAD[1]"));
-                disconnect_port(ctx, ci, ctx->id("RAD[2]"));
-                disconnect_port(ctx, ci, ctx->id("RAD[3]"));
+                disconnect_port(ctx, ci, ctx->id("RAD[0]"), &tx);
+                disconnect_port(ctx, ci, ctx->id("RAD[1]"), &tx);
+                disconnect_port(ctx, ci, ctx->id("RAD[2]"), &tx);
+                disconnect_port(ctx, ci, ctx->id("RAD[3]"), &tx);
 
                 // Attempt to pack FFs into RAM slices
                 std::vector<std::tuple<CellInfo *, CellInfo *, int>> ff_packing;
@@ -643,7 +645,7 @@ class Ecp5Packer
                 }
 
                 for (auto ff : ff_packing)
-                    ff_to_slice(ctx, std::get<0>(ff), std::get<1>(ff), std::get<2>(ff), true);
+                    ff_to_slice(ctx, std::get<0>(ff), std::get<1>(ff), std::get<2>(ff), true, &tx);
 
                 // Setup placement constraints
                 ram0_slice->constr_abs_z = true;
@@ -682,13 +684,13 @@ class Ecp5Packer
             std::unique_ptr<CellInfo> slice =
                     create_ecp5_cell(ctx, ctx->id("TRELLIS_SLICE"), lut0->name.str(ctx) + "_SLICE");
 
-            lut_to_slice(ctx, lut0, slice.get(), 0);
-            lut_to_slice(ctx, lut1, slice.get(), 1);
+            lut_to_slice(ctx, lut0, slice.get(), 0, &tx);
+            lut_to_slice(ctx, lut1, slice.get(), 1, &tx);
 
             auto ff0 = lutffPairs.find(lut0->name);
 
             if (ff0 != lutffPairs.end()) {
-                ff_to_slice(ctx, ctx->cells.at(ff0->second).get(), slice.get(), 0, true);
+                ff_to_slice(ctx, ctx->cells.at(ff0->second).get(), slice.get(), 0, true, &tx);
                 packed_cells.insert(ff0->second);
                 fflutPairs.erase(ff0->second);
                 lutffPairs.erase(lut0->name);
@@ -697,7 +699,7 @@ class Ecp5Packer
             auto ff1 = lutffPairs.find(lut1->name);
 
             if (ff1 != lutffPairs.end()) {
-                ff_to_slice(ctx, ctx->cells.at(ff1->second).get(), slice.get(), 1, true);
+                ff_to_slice(ctx, ctx->cells.at(ff1->second).get(), slice.get(), 1, true, &tx);
                 packed_cells.insert(ff1->second);
                 fflutPairs.erase(ff1->second);
                 lutffPairs.erase(lut1->name);
@@ -720,11 +722,11 @@ class Ecp5Packer
             if (is_lut(ctx, ci)) {
                 std::unique_ptr<CellInfo> slice =
                         create_ecp5_cell(ctx, ctx->id("TRELLIS_SLICE"), ci->name.str(ctx) + "_SLICE");
-                lut_to_slice(ctx, ci, slice.get(), 0);
+                lut_to_slice(ctx, ci, slice.get(), 0, &tx);
                 auto ff = lutffPairs.find(ci->name);
 
                 if (ff != lutffPairs.end()) {
-                    ff_to_slice(ctx, ctx->cells.at(ff->second).get(), slice.get(), 0, true);
+                    ff_to_slice(ctx, ctx->cells.at(ff->second).get(), slice.get(), 0, true, &tx);
                     packed_cells.insert(ff->second);
                     fflutPairs.erase(ff->second);
                     lutffPairs.erase(ci->name);
@@ -746,7 +748,7 @@ class Ecp5Packer
             if (is_ff(ctx, ci)) {
                 std::unique_ptr<CellInfo> slice =
                         create_ecp5_cell(ctx, ctx->id("TRELLIS_SLICE"), ci->name.str(ctx) + "_SLICE");
-                ff_to_slice(ctx, ci, slice.get(), 0, false);
+                ff_to_slice(ctx, ci, slice.get(), 0, false, &tx);
                 new_cells.push_back(std::move(slice));
                 packed_cells.insert(ci->name);
             }
@@ -1054,9 +1056,12 @@ class Ecp5Packer
 
   private:
     Context *ctx;
+    // Smallest number of cells given to each thread by the parallel searches
+    size_t parallel_chunk;
 
     std::unordered_set<IdString> packed_cells;
     std::vector<std::unique_ptr<CellInfo>> new_cells;
+    NetlistTransaction tx;
 
     struct SliceUsage
     {
@@ -1114,6 +1119,12 @@ void Arch::assignArchInfo()
             ci->sliceInfo.srmode = id(str_or_default(ci->params, id_SRMODE, "LSR_OVER_CE"));
         }
     }
+    // Slices that are already bound may have changed
+    for (auto &cell : cells) {
+        CellInfo *ci = cell.second.get();
+        if (ci->type == id_TRELLIS_SLICE && ci->bel != BelId())
+            rebuildSliceTile(ci->bel);
+    }
 }
 
 NEXTPNR_NAMESPACE_END
@@ -194,6 +194,34 @@ void Arch::setBelAttr(IdString bel, IdString key, const std::string &value) { be
 
 Arch::Arch(ArchArgs args) : chipName("generic"), args(args) {}
 
+void Arch::copyDeviceFrom(const Arch &other)
+{
+    chipName = other.chipName;
+    wires = other.wires;
+    pips = other.pips;
+    bels = other.bels;
+    groups = other.groups;
+    bel_ids = other.bel_ids;
+    wire_ids = other.wire_ids;
+    pip_ids = other.pip_ids;
+    bel_by_loc = other.bel_by_loc;
+    bels_by_tile = other.bels_by_tile;
+    decal_graphics = other.decal_graphics;
+    gridDimX = other.gridDimX;
+    gridDimY = other.gridDimY;
+    tileBelDimZ = other.tileBelDimZ;
+    tilePipDimZ = other.tilePipDimZ;
+    grid_distance_to_delay = other.grid_distance_to_delay;
+
+    // The bindings point into the other context's netlist.
+    for (auto &wire : wires)
+        wire.second.bound_net = nullptr;
+    for (auto &pip : pips)
+        pip.second.bound_net = nullptr;
+    for (auto &bel : bels)
+        bel.second.bound_cell = nullptr;
+}
+
 void IdString::initialize_arch(const BaseCtx *ctx) {}
 
 // ---------------------------------------------------------------
@@ -302,6 +330,7 @@ void Arch::bindWire(WireId wire, NetInfo *net, PlaceStrength strength)
 
 void Arch::unbindWire(WireId wire)
 {
+    wires.at(wire).bound_net->route_gen++;
     auto &net_wires = wires.at(wire).bound_net->wires;
 
     auto pip = net_wires.at(wire).pip;
@@ -361,6 +390,7 @@ void Arch::unbindPip(PipId pip)
 {
     WireId wire = pips.at(pip).dstWire;
     wires.at(wire).bound_net->wires.erase(wire);
+    wires.at(wire).bound_net->route_gen++;
     pips.at(pip).bound_net = nullptr;
     wires.at(wire).bound_net = nullptr;
     refreshUiPip(pip);
@@ -425,8 +455,13 @@ delay_t Arch::estimateDelay(WireId src, WireId dst) const
 delay_t Arch::predictDelay(const NetInfo *net_info, const PortRef &sink) const
 {
     const auto &driver = net_info->driver;
-    auto driver_loc = getBelLocation(driver.cell->bel);
-    auto sink_loc = getBelLocation(sink.cell->bel);
+    return predictDelay(driver.cell->bel, driver.port, sink.cell->bel, sink.port);
+}
+
+delay_t Arch::predictDelay(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const
+{
+    auto driver_loc = getBelLocation(src_bel);
+    auto sink_loc = getBelLocation(dst_bel);
 
     int dx = abs(driver_loc.x - driver_loc.x);
     int dy = abs(sink_loc.y - sink_loc.y);
@@ -467,6 +502,7 @@ TimingPortClass Arch::getPortTimingClass(const CellInfo *cell, IdString port, Id
 }
 
 bool Arch::isValidBelForCell(CellInfo *cell, BelId bel) const { return true; }
+bool Arch::isValidBelForCell(CellInfo *cell, BelId bel, CellInfo *replaced) const { return true; }
 bool Arch::isBelLocationValid(BelId bel) const { return true; }
 
 NEXTPNR_NAMESPACE_END
@@ -138,6 +138,7 @@ struct Arch : BaseCtx
     IdString archId() const { return id("generic"); }
     ArchArgs archArgs() const { return args; }
     IdString archArgsToId(ArchArgs args) const { return id("none"); }
+    void copyDeviceFrom(const Arch &other);
 
     int getGridDimX() const { return gridDimX; }
     int getGridDimY() const { return gridDimY; }
@@ -206,6 +207,7 @@ struct Arch : BaseCtx
 
     delay_t estimateDelay(WireId src, WireId dst) const;
     delay_t predictDelay(const NetInfo *net_info, const PortRef &sink) const;
+    delay_t predictDelay(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const;
     delay_t getDelayEpsilon() const { return 0.01; }
     delay_t getRipupDelayPenalty() const { return 1.0; }
     float getDelayNS(delay_t v) const { return v; }
@@ -227,7 +229,10 @@ struct Arch : BaseCtx
     TimingPortClass getPortTimingClass(const CellInfo *cell, IdString port, IdString &clockPort) const;
 
     bool isValidBelForCell(CellInfo *cell, BelId bel) const;
+    bool isValidBelForCell(CellInfo *cell, BelId bel, CellInfo *replaced) const;
     bool isBelLocationValid(BelId bel) const;
+
+    void assignArchInfo() {}
 };
 
 NEXTPNR_NAMESPACE_END
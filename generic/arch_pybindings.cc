@@ -34,7 +34,8 @@ void arch_wrap_python()
                            .def("checksum", &Context::checksum)
                            .def("pack", &Context::pack)
                            .def("place", &Context::place)
-                           .def("route", &Context::route);
+                           .def("route", &Context::route)
+                           .def("clone", clone_context_shim, return_value_policy<manage_new_object>());
 }
 
 NEXTPNR_NAMESPACE_END
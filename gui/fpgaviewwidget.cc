@@ -19,6 +19,7 @@
 
 #include <cstdio>
 #include <math.h>
+#include <set>
 
 #include <QApplication>
 #include <QCoreApplication>
@@ -31,6 +32,7 @@
 #include "fpgaviewwidget.h"
 #include "log.h"
 #include "mainwindow.h"
+#include "util.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
@@ -46,6 +48,7 @@ FPGAViewWidget::FPGAViewWidget(QWidget *parent)
     colors_.active = QColor("#f0f0f0");
     colors_.selected = QColor("#ff6600");
     colors_.hovered = QColor("#906030");
+    colors_.congestion = QColor("#ff3030");
     colors_.highlight[0] = QColor("#6495ed");
     colors_.highlight[1] = QColor("#7fffd4");
     colors_.highlight[2] = QColor("#98fb98");
@@ -86,6 +89,7 @@ FPGAViewWidget::~FPGAViewWidget() {}
 void FPGAViewWidget::newContext(Context *ctx)
 {
     ctx_ = ctx;
+    ctx_->uiSnapshotEnabled = true;
     onSelectedArchItem(std::vector<DecalXY>(), false);
     for (int i = 0; i < 8; i++)
         onHighlightGroupChanged(std::vector<DecalXY>(), i);
@@ -124,16 +128,21 @@ void FPGAViewWidget::initializeGL()
     }
 }
 
-float FPGAViewWidget::PickedElement::distance(Context *ctx, float wx, float wy) const
+// Graphics of a decal, or none if they were never fetched.
+static const std::vector<GraphicElement> &
+findGraphics(const std::unordered_map<DecalId, std::vector<GraphicElement>> &graphics, DecalId decal)
 {
-    // Get DecalXY for this element.
-    DecalXY dec = decal(ctx);
+    static const std::vector<GraphicElement> none;
+    auto fnd = graphics.find(decal);
+    return fnd == graphics.end() ? none : fnd->second;
+}
 
+float FPGAViewWidget::PickedElement::distance(const std::vector<GraphicElement> &graphics, float wx, float wy) const
+{
     // Coordinates within decal.
-    float dx = wx - dec.x;
-    float dy = wy - dec.y;
+    float dx = wx - decal.x;
+    float dy = wy - decal.y;
 
-    auto graphics = ctx->getDecalGraphics(dec.decal);
     if (graphics.size() == 0)
         return -1;
 
@@ -215,7 +224,8 @@ void FPGAViewWidget::renderGraphicElement(LineShaderData &out, PickQuadTree::Bou
     }
 }
 
-void FPGAViewWidget::renderDecal(LineShaderData &out, PickQuadTree::BoundingBox &bb, const DecalXY &decal)
+void FPGAViewWidget::renderDecal(LineShaderData &out, PickQuadTree::BoundingBox &bb, const DecalGraphics &graphics,
+                                 const DecalXY &decal)
 {
     if (decal.decal == DecalId())
         return;
@@ -223,18 +233,18 @@ void FPGAViewWidget::renderDecal(LineShaderData &out, PickQuadTree::BoundingBox
     float offsetX = decal.x;
     float offsetY = decal.y;
 
-    for (auto &el : ctx_->getDecalGraphics(decal.decal)) {
+    for (auto &el : findGraphics(graphics, decal.decal)) {
         renderGraphicElement(out, bb, el, offsetX, offsetY);
     }
 }
 
 void FPGAViewWidget::renderArchDecal(LineShaderData out[GraphicElement::STYLE_MAX], PickQuadTree::BoundingBox &bb,
-                                     const DecalXY &decal)
+                                     const DecalXY &decal, const std::vector<GraphicElement> &graphics)
 {
     float offsetX = decal.x;
     float offsetY = decal.y;
 
-    for (auto &el : ctx_->getDecalGraphics(decal.decal)) {
+    for (auto &el : graphics) {
         switch (el.style) {
         case GraphicElement::STYLE_FRAME:
         case GraphicElement::STYLE_INACTIVE:
@@ -247,20 +257,110 @@ void FPGAViewWidget::renderArchDecal(LineShaderData out[GraphicElement::STYLE_MA
     }
 }
 
-void FPGAViewWidget::populateQuadTree(RendererData *data, const DecalXY &decal, const PickedElement &element)
+void FPGAViewWidget::renderChunk(const ChunkObjects &objects, const DecalGraphics &graphics, RendererChunk &chunk)
+{
+    for (int i = 0; i < GraphicElement::STYLE_MAX; i++)
+        chunk.gfxByStyle[i].clear();
+    chunk.bb.clear();
+    chunk.objects = 0;
+    chunk.active = 0;
+    chunk.congestion = 0;
+    for (auto const &object : objects) {
+        if (object.type == ElementType::WIRE) {
+            auto fnd = wireCongestion_.find(object.wire);
+            if (fnd != wireCongestion_.end())
+                chunk.congestion += fnd->second;
+        }
+
+        const auto &objectGraphics = findGraphics(graphics, object.decal.decal);
+        renderArchDecal(chunk.gfxByStyle, chunk.bb, object.decal, objectGraphics);
+
+        // Count objects that are drawn at all, and those drawn as in use.
+        bool drawn = false, active = false;
+        for (auto &el : objectGraphics) {
+            if (el.style == GraphicElement::STYLE_INACTIVE || el.style == GraphicElement::STYLE_ACTIVE)
+                drawn = true;
+            if (el.style == GraphicElement::STYLE_ACTIVE)
+                active = true;
+        }
+        if (drawn)
+            chunk.objects++;
+        if (active)
+            chunk.active++;
+    }
+    populateChunkQuadTree(objects, graphics, chunk);
+}
+
+void FPGAViewWidget::renderHeatmap(const std::vector<RendererChunk> &chunks, LineShaderData out[heatmapLevels_])
+{
+    for (int i = 0; i < heatmapLevels_; i++)
+        out[i].clear();
+
+    for (auto const &chunk : chunks) {
+        if (chunk.objects == 0)
+            continue;
+        // Level 0 is kept for chunks with nothing in use, so that any use at
+        // all is visible.
+        int level = 0;
+        if (chunk.active > 0)
+            level = 1 + (chunk.active * (heatmapLevels_ - 1) - 1) / chunk.objects;
+
+        // Cells are drawn as a horizontal line through the middle of the
+        // chunk, with the line as thick as the chunk is high.
+        float x0 = chunk.loc.first * chunkSize_;
+        float y = (chunk.loc.second + 0.5f) * chunkSize_;
+        PolyLine(x0, y, x0 + chunkSize_, y).build(out[level]);
+    }
+
+    for (int i = 0; i < heatmapLevels_; i++)
+        out[i].last_render = ++lastRender_;
+}
+
+void FPGAViewWidget::renderCongestion(const std::vector<RendererChunk> &chunks, LineShaderData out[heatmapLevels_])
+{
+    for (int i = 0; i < heatmapLevels_; i++)
+        out[i].clear();
+
+    int maxCongestion = 0;
+    for (auto const &chunk : chunks)
+        maxCongestion = std::max(maxCongestion, chunk.congestion);
+
+    for (auto const &chunk : chunks) {
+        if (chunk.congestion <= 0)
+            continue;
+        int level = (chunk.congestion * heatmapLevels_ - 1) / maxCongestion;
+
+        // Outline the chunk, slightly inset so that neighbours stay apart.
+        float inset = chunkSize_ * 0.05f;
+        float x0 = chunk.loc.first * chunkSize_ + inset, y0 = chunk.loc.second * chunkSize_ + inset;
+        float x1 = x0 + chunkSize_ - 2 * inset, y1 = y0 + chunkSize_ - 2 * inset;
+        PolyLine line(true);
+        line.point(x0, y0);
+        line.point(x1, y0);
+        line.point(x1, y1);
+        line.point(x0, y1);
+        line.build(out[level]);
+    }
+
+    for (int i = 0; i < heatmapLevels_; i++)
+        out[i].last_render = ++lastRender_;
+}
+
+void FPGAViewWidget::populateQuadTree(std::vector<std::pair<PickQuadTree::BoundingBox, PickedElement>> &elems,
+                                      const DecalGraphics &graphics, const PickedElement &element)
 {
-    float x = decal.x;
-    float y = decal.y;
+    float x = element.decal.x;
+    float y = element.decal.y;
 
-    for (auto &el : ctx_->getDecalGraphics(decal.decal)) {
+    for (auto &el : findGraphics(graphics, element.decal.decal)) {
         if (el.style == GraphicElement::STYLE_HIDDEN || el.style == GraphicElement::STYLE_FRAME) {
             continue;
         }
 
-        bool res = true;
         if (el.type == GraphicElement::TYPE_BOX) {
             // Boxes are bounded by themselves.
-            res = data->qt->insert(PickQuadTree::BoundingBox(x + el.x1, y + el.y1, x + el.x2, y + el.y2), element);
+            elems.push_back(
+                    std::make_pair(PickQuadTree::BoundingBox(x + el.x1, y + el.y1, x + el.x2, y + el.y2), element));
         }
 
         if (el.type == GraphicElement::TYPE_LINE || el.type == GraphicElement::TYPE_ARROW) {
@@ -279,13 +379,190 @@ void FPGAViewWidget::populateQuadTree(RendererData *data, const DecalXY &decal,
             x1 += 0.01;
             y1 += 0.01;
 
-            res = data->qt->insert(PickQuadTree::BoundingBox(x0, y0, x1, y1), element);
+            elems.push_back(std::make_pair(PickQuadTree::BoundingBox(x0, y0, x1, y1), element));
         }
+    }
+}
+
+void FPGAViewWidget::populateChunkQuadTree(const ChunkObjects &objects, const DecalGraphics &graphics,
+                                           RendererChunk &chunk)
+{
+    chunk.qt = nullptr;
+    // Chunks with only hidden graphics have nothing to pick.
+    if (chunk.bb.w() < 0 || chunk.bb.h() < 0)
+        return;
+
+    // Enlarge the bounding box slightly for the picking - when we insert
+    // elements into it, we enlarge their bounding boxes slightly, so
+    // we need to give ourselves some sagery margin here.
+    auto bb = chunk.bb;
+    bb.setX0(bb.x0() - 1);
+    bb.setY0(bb.y0() - 1);
+    bb.setX1(bb.x1() + 1);
+    bb.setY1(bb.y1() + 1);
+
+    // Gather the bounding boxes of all elements first, so that the tree can
+    // be built in one go instead of splitting nodes as it fills up.
+    std::vector<std::pair<PickQuadTree::BoundingBox, PickedElement>> elems;
+    for (auto const &object : objects) {
+        populateQuadTree(elems, graphics, object);
+    }
+    chunk.qt = std::unique_ptr<PickQuadTree>(new PickQuadTree(bb));
+    if (!chunk.qt->bulk_insert(std::move(elems))) {
+        NPNR_ASSERT_FALSE("populateChunkQuadTree: could not insert elements");
+    }
+}
 
-        if (!res) {
-            NPNR_ASSERT_FALSE("populateQuadTree: could not insert element");
+FPGAViewWidget::ChunkSlot *FPGAViewWidget::findSlot(const PickedElement &element)
+{
+    switch (element.type) {
+    case ElementType::BEL: {
+        auto fnd = belSlots_.find(element.bel);
+        return fnd == belSlots_.end() ? nullptr : &fnd->second;
+    }
+    case ElementType::WIRE: {
+        auto fnd = wireSlots_.find(element.wire);
+        return fnd == wireSlots_.end() ? nullptr : &fnd->second;
+    }
+    case ElementType::PIP: {
+        auto fnd = pipSlots_.find(element.pip);
+        return fnd == pipSlots_.end() ? nullptr : &fnd->second;
+    }
+    case ElementType::GROUP: {
+        auto fnd = groupSlots_.find(element.group);
+        return fnd == groupSlots_.end() ? nullptr : &fnd->second;
+    }
+    default:
+        NPNR_ASSERT_FALSE("Invalid ElementType");
+    }
+    return nullptr;
+}
+
+// Must be called with the UI lock taken.
+DecalXY FPGAViewWidget::queryDecal(const PickedElement &element)
+{
+    switch (element.type) {
+    case ElementType::BEL:
+        return ctx_->getBelDecal(element.bel);
+    case ElementType::WIRE:
+        return ctx_->getWireDecal(element.wire);
+    case ElementType::PIP:
+        return ctx_->getPipDecal(element.pip);
+    case ElementType::GROUP:
+        return ctx_->getGroupDecal(element.group);
+    default:
+        NPNR_ASSERT_FALSE("Invalid ElementType");
+    }
+    return DecalXY();
+}
+
+// Must be called with the UI lock taken.
+void FPGAViewWidget::queryDecalGraphics(DecalGraphics &graphics, DecalId decal)
+{
+    if (decal == DecalId() || graphics.count(decal))
+        return;
+    auto decalGraphics = ctx_->getDecalGraphics(decal);
+    graphics[decal] = std::vector<GraphicElement>(decalGraphics.begin(), decalGraphics.end());
+}
+
+std::pair<int, int> FPGAViewWidget::chunkLocation(const DecalGraphics &graphics, const DecalXY &decal) const
+{
+    // Objects are placed into the chunk containing the start of their
+    // graphics; the decal itself is usually at the origin.
+    const auto &decalGraphics = findGraphics(graphics, decal.decal);
+    std::pair<int, int> loc(0, 0);
+    if (!decalGraphics.empty()) {
+        loc.first = int(std::floor((decal.x + decalGraphics.front().x1) / chunkSize_));
+        loc.second = int(std::floor((decal.y + decalGraphics.front().y1) / chunkSize_));
+    }
+    return loc;
+}
+
+void FPGAViewWidget::addChunkObject(const PickedElement &element, std::pair<int, int> loc,
+                                    std::map<std::pair<int, int>, int> &chunkByLoc, RendererData *data)
+{
+    auto fnd = chunkByLoc.find(loc);
+    int chunk;
+    if (fnd == chunkByLoc.end()) {
+        chunk = int(data->chunks.size());
+        chunkByLoc[loc] = chunk;
+        data->chunks.emplace_back();
+        data->chunks.back().loc = loc;
+        chunkObjects_.emplace_back();
+    } else {
+        chunk = fnd->second;
+    }
+
+    ChunkSlot slot{chunk, int(chunkObjects_.at(chunk).size())};
+    switch (element.type) {
+    case ElementType::BEL:
+        belSlots_[element.bel] = slot;
+        break;
+    case ElementType::WIRE:
+        wireSlots_[element.wire] = slot;
+        break;
+    case ElementType::PIP:
+        pipSlots_[element.pip] = slot;
+        break;
+    case ElementType::GROUP:
+        groupSlots_[element.group] = slot;
+        break;
+    default:
+        NPNR_ASSERT_FALSE("Invalid ElementType");
+    }
+    chunkObjects_.at(chunk).push_back(element);
+}
+
+// Rebuild every chunk from scratch. The objects are enumerated from the
+// device, which does not change while the UI is attached, and their decals
+// and graphics are then queried in slices under the UI lock, so that the
+// processing code is only held up for a slice at its yield points. Objects
+// that change in the meantime are published as deltas and applied later.
+void FPGAViewWidget::reloadAll(RendererData *data)
+{
+    chunkObjects_.clear();
+    belSlots_.clear();
+    wireSlots_.clear();
+    pipSlots_.clear();
+    groupSlots_.clear();
+
+    ChunkObjects objects;
+    for (auto bel : ctx_->getBels())
+        objects.push_back(PickedElement::fromBel(bel));
+    for (auto wire : ctx_->getWires())
+        objects.push_back(PickedElement::fromWire(wire));
+    for (auto pip : ctx_->getPips())
+        objects.push_back(PickedElement::fromPip(pip));
+    for (auto group : ctx_->getGroups())
+        objects.push_back(PickedElement::fromGroup(group));
+
+    const size_t slice = 4096;
+    for (size_t begin = 0; begin < objects.size(); begin += slice) {
+        size_t end = std::min(objects.size(), begin + slice);
+        ctx_->lock_ui();
+        for (size_t i = begin; i < end; i++) {
+            auto &object = objects.at(i);
+            object.decal = queryDecal(object);
+            queryDecalGraphics(data->decalGraphics, object.decal.decal);
         }
+        ctx_->unlock_ui();
+    }
+
+    std::map<std::pair<int, int>, int> chunkByLoc;
+    for (auto const &object : objects) {
+        addChunkObject(object, chunkLocation(data->decalGraphics, object.decal), chunkByLoc, data);
     }
+
+    // Tessellate each chunk and build its picking tree. Chunks share no
+    // state and the graphics are only read, so every thread writes only to
+    // its own chunks.
+    parallel_for_chunks(
+            data->chunks.size(),
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    renderChunk(chunkObjects_.at(i), data->decalGraphics, data->chunks.at(i));
+            },
+            16);
 }
 
 QMatrix4x4 FPGAViewWidget::getProjection(void)
@@ -314,8 +591,13 @@ void FPGAViewWidget::paintGL()
     float thick11Px = mouseToWorldDimensions(1.1, 0).x();
     float thick2Px = mouseToWorldDimensions(2, 0).x();
 
+    // When chunks are too small on screen to make out their contents, draw
+    // a summary of them instead.
+    lodActive_ = thick1Px * lodChunkPixels_ > chunkSize_;
+
     {
         QMutexLocker locker(&rendererDataLock_);
+        updateVisibleChunks();
         // Must be called from a thread holding the OpenGL context
         update_vbos();
     }
@@ -324,15 +606,35 @@ void FPGAViewWidget::paintGL()
     lineShader_.draw(GraphicElement::STYLE_GRID, colors_.grid, thick1Px,
                                                                 matrix);
 
-    // Render Arch graphics.
+    // Render the low zoom summary, from unused to fully used chunks.
+    if (lodActive_) {
+        for (int i = 0; i < heatmapLevels_; i++) {
+            float t = float(i) / (heatmapLevels_ - 1);
+            QColor color = QColor::fromRgbF(colors_.inactive.redF() * (1 - t) + colors_.active.redF() * t,
+                                            colors_.inactive.greenF() * (1 - t) + colors_.active.greenF() * t,
+                                            colors_.inactive.blueF() * (1 - t) + colors_.active.blueF() * t);
+            lineShader_.draw_layer(i, color, chunkSize_, matrix);
+        }
+    }
+
+    // Render Arch graphics, only for the chunks in view.
     lineShader_.draw(GraphicElement::STYLE_FRAME, colors_.frame, thick11Px,
-                                                                   matrix);
+                                                   matrix, &visibleChunks_);
     lineShader_.draw(GraphicElement::STYLE_HIDDEN, colors_.hidden, thick11Px,
-                                                                     matrix);
+                                                   matrix, &visibleChunks_);
     lineShader_.draw(GraphicElement::STYLE_INACTIVE, colors_.inactive,
-                                                   thick11Px, matrix);
+                                        thick11Px, matrix, &visibleChunks_);
     lineShader_.draw(GraphicElement::STYLE_ACTIVE, colors_.active, thick11Px,
-                                                                     matrix);
+                                                   matrix, &visibleChunks_);
+
+    // Render the routing congestion overlay, from least to most congested.
+    for (int i = 0; i < heatmapLevels_; i++) {
+        float t = float(i + 1) / heatmapLevels_;
+        QColor color = QColor::fromRgbF(colors_.grid.redF() * (1 - t) + colors_.congestion.redF() * t,
+                                        colors_.grid.greenF() * (1 - t) + colors_.congestion.greenF() * t,
+                                        colors_.grid.blueF() * (1 - t) + colors_.congestion.blueF() * t);
+        lineShader_.draw_layer(heatmapLevels_ + i, color, thick2Px, matrix);
+    }
 
     // Draw highlighted items.
     for (int i = 0; i < 8; i++) {
@@ -353,7 +655,7 @@ void FPGAViewWidget::paintGL()
     if (flags.zoomOutbound) {
         // If we're doing init zoomOutbound, make sure we're actually drawing
         // something already.
-        if (rendererData_->gfxByStyle[GraphicElement::STYLE_FRAME].vertices.size() != 0) {
+        if (rendererData_->chunks.size() != 0) {
             zoomOutbound();
             flags.zoomOutbound = false;
             {
@@ -383,60 +685,39 @@ void FPGAViewWidget::renderLines(void)
     if (ctx_ == nullptr)
         return;
 
-    // Data from Context needed to render all decals.
-    std::vector<std::pair<DecalXY, BelId>> belDecals;
-    std::vector<std::pair<DecalXY, WireId>> wireDecals;
-    std::vector<std::pair<DecalXY, PipId>> pipDecals;
-    std::vector<std::pair<DecalXY, GroupId>> groupDecals;
-    bool decalsChanged = false;
+    // Whether everything must be rendered again, and the objects whose
+    // state changed since the last snapshot that asked for it, with the
+    // graphics of their new decals.
+    bool fullReload = false;
+    ChunkObjects decals;
+    DecalGraphics graphics;
+    std::vector<std::pair<WireId, int>> congestion;
     {
-        // Take the UI/Normal mutex on the Context, copy over all we need as
-        // fast as we can.
-        std::lock_guard<std::mutex> lock_ui(ctx_->ui_mutex);
-        std::lock_guard<std::mutex> lock(ctx_->mutex);
-
-        // For now, collapse any decal changes into change of all decals.
-        // TODO(q3k): fix this
-        if (ctx_->allUiReload) {
-            ctx_->allUiReload = false;
-            decalsChanged = true;
-        }
-        if (ctx_->frameUiReload) {
-            ctx_->frameUiReload = false;
-            decalsChanged = true;
-        }
-        if (ctx_->belUiReload.size() > 0) {
-            ctx_->belUiReload.clear();
-            decalsChanged = true;
-        }
-        if (ctx_->wireUiReload.size() > 0) {
-            ctx_->wireUiReload.clear();
-            decalsChanged = true;
-        }
-        if (ctx_->pipUiReload.size() > 0) {
-            ctx_->pipUiReload.clear();
-            decalsChanged = true;
-        }
-        if (ctx_->groupUiReload.size() > 0) {
-            ctx_->groupUiReload.clear();
-            decalsChanged = true;
-        }
-
-        // Local copy of decals, taken as fast as possible to not block the P&R.
-        if (decalsChanged) {
-            for (auto bel : ctx_->getBels()) {
-                belDecals.push_back({ctx_->getBelDecal(bel), bel});
-            }
-            for (auto wire : ctx_->getWires()) {
-                wireDecals.push_back({ctx_->getWireDecal(wire), wire});
-            }
-            for (auto pip : ctx_->getPips()) {
-                pipDecals.push_back({ctx_->getPipDecal(pip), pip});
-            }
-            for (auto group : ctx_->getGroups()) {
-                groupDecals.push_back({ctx_->getGroupDecal(group), group});
-            }
+        // The processing code publishes snapshots when it yields or
+        // unlocks. When it is not running, publish them here instead, but
+        // never wait for the lock so that it is never held up by the UI.
+        // Only the objects that changed are published, so this is cheap.
+        std::unique_lock<std::mutex> lock(ctx_->mutex, std::try_to_lock);
+        if (lock.owns_lock())
+            ctx_->publishUi();
+    }
+    for (auto &snapshot : ctx_->takeUiSnapshots()) {
+        if (snapshot.full) {
+            fullReload = true;
+            decals.clear();
+            graphics.clear();
         }
+        for (auto &bel : snapshot.bels)
+            decals.push_back(PickedElement::fromBel(bel.first, bel.second));
+        for (auto &wire : snapshot.wires)
+            decals.push_back(PickedElement::fromWire(wire.first, wire.second));
+        for (auto &pip : snapshot.pips)
+            decals.push_back(PickedElement::fromPip(pip.first, pip.second));
+        for (auto &group : snapshot.groups)
+            decals.push_back(PickedElement::fromGroup(group.first, group.second));
+        for (auto &decal : snapshot.graphics)
+            graphics[decal.first] = std::move(decal.second);
+        congestion.insert(congestion.end(), snapshot.congestion.begin(), snapshot.congestion.end());
     }
 
     // Arguments from the main UI thread on what we should render.
@@ -460,68 +741,29 @@ void FPGAViewWidget::renderLines(void)
         flags = rendererArgs_->flags;
     }
 
-    // Render decals if necessary.
-    if (decalsChanged) {
-        int last_render[GraphicElement::STYLE_HIGHLIGHTED0];
-        {
-            QMutexLocker locker(&rendererDataLock_);
-            for(int i =0; i<GraphicElement::STYLE_HIGHLIGHTED0; i++)
-                last_render[i] = rendererData_->gfxByStyle[(enum GraphicElement::style_t)i].last_render;
-        }
-        
+    // Render all decals into new chunks.
+    if (fullReload) {
         auto data = std::unique_ptr<FPGAViewWidget::RendererData>(new FPGAViewWidget::RendererData);
+        reloadAll(data.get());
+
         // Reset bounding box.
         data->bbGlobal.clear();
-
-        // Draw Bels.
-        for (auto const &decal : belDecals) {
-            renderArchDecal(data->gfxByStyle, data->bbGlobal, decal.first);
-        }
-        // Draw Wires.
-        for (auto const &decal : wireDecals) {
-            renderArchDecal(data->gfxByStyle, data->bbGlobal, decal.first);
-        }
-        // Draw Pips.
-        for (auto const &decal : pipDecals) {
-            renderArchDecal(data->gfxByStyle, data->bbGlobal, decal.first);
-        }
-        // Draw Groups.
-        for (auto const &decal : groupDecals) {
-            renderArchDecal(data->gfxByStyle, data->bbGlobal, decal.first);
+        for (size_t i = 0; i < data->chunks.size(); i++) {
+            auto &chunk = data->chunks.at(i);
+            for (int j = 0; j < GraphicElement::STYLE_MAX; j++)
+                chunk.gfxByStyle[j].last_render = ++lastRender_;
+            if (chunk.bb.w() >= 0 && chunk.bb.h() >= 0) {
+                data->bbGlobal.setX0(std::min(data->bbGlobal.x0(), chunk.bb.x0()));
+                data->bbGlobal.setY0(std::min(data->bbGlobal.y0(), chunk.bb.y0()));
+                data->bbGlobal.setX1(std::max(data->bbGlobal.x1(), chunk.bb.x1()));
+                data->bbGlobal.setY1(std::max(data->bbGlobal.y1(), chunk.bb.y1()));
+            }
         }
 
         // Bounding box should be calculated by now.
         NPNR_ASSERT(data->bbGlobal.w() != 0);
         NPNR_ASSERT(data->bbGlobal.h() != 0);
 
-        // Enlarge the bounding box slightly for the picking - when we insert
-        // elements into it, we enlarge their bounding boxes slightly, so
-        // we need to give ourselves some sagery margin here.
-        auto bb = data->bbGlobal;
-        bb.setX0(bb.x0() - 1);
-        bb.setY0(bb.y0() - 1);
-        bb.setX1(bb.x1() + 1);
-        bb.setY1(bb.y1() + 1);
-
-        // Populate picking quadtree.
-        data->qt = std::unique_ptr<PickQuadTree>(new PickQuadTree(bb));
-        for (auto const &decal : belDecals) {
-            populateQuadTree(data.get(), decal.first,
-                             PickedElement::fromBel(decal.second, decal.first.x, decal.first.y));
-        }
-        for (auto const &decal : wireDecals) {
-            populateQuadTree(data.get(), decal.first,
-                             PickedElement::fromWire(decal.second, decal.first.x, decal.first.y));
-        }
-        for (auto const &decal : pipDecals) {
-            populateQuadTree(data.get(), decal.first,
-                             PickedElement::fromPip(decal.second, decal.first.x, decal.first.y));
-        }
-        for (auto const &decal : groupDecals) {
-            populateQuadTree(data.get(), decal.first,
-                             PickedElement::fromGroup(decal.second, decal.first.x, decal.first.y));
-        }
-
         // Swap over.
         {
             QMutexLocker lock(&rendererDataLock_);
@@ -534,14 +776,91 @@ void FPGAViewWidget::renderLines(void)
                 for (int i = 0; i < 8; i++)
                     data->gfxHighlighted[i] = rendererData_->gfxHighlighted[i];
             }
-            for(int i =0; i<GraphicElement::STYLE_HIGHLIGHTED0; i++)
-                data->gfxByStyle[(enum GraphicElement::style_t)i].last_render = ++last_render[i];
             rendererData_ = std::move(data);
         }
     }
+    if (!graphics.empty()) {
+        QMutexLocker lock(&rendererDataLock_);
+        for (auto &decal : graphics)
+            rendererData_->decalGraphics[decal.first] = std::move(decal.second);
+    }
+    if (!decals.empty()) {
+        // Update the decals of the changed objects, and render again only
+        // the chunks containing them.
+        std::set<int> dirtyChunks;
+        for (auto const &decal : decals) {
+            ChunkSlot *slot = findSlot(decal);
+            if (slot == nullptr)
+                continue;
+            chunkObjects_.at(slot->chunk).at(slot->index) = decal;
+            dirtyChunks.insert(slot->chunk);
+        }
+
+        for (int i : dirtyChunks) {
+            RendererChunk chunk;
+            // Only this thread changes the chunks, so reading them without
+            // the lock is fine.
+            chunk.loc = rendererData_->chunks.at(i).loc;
+            renderChunk(chunkObjects_.at(i), rendererData_->decalGraphics, chunk);
+            for (int j = 0; j < GraphicElement::STYLE_MAX; j++)
+                chunk.gfxByStyle[j].last_render = ++lastRender_;
+
+            QMutexLocker lock(&rendererDataLock_);
+            rendererData_->chunks.at(i) = std::move(chunk);
+        }
+    }
+
+    // Apply the congestion scores to the chunks containing the wires.
+    if (!congestion.empty()) {
+        QMutexLocker lock(&rendererDataLock_);
+        for (auto const &wire : congestion) {
+            int &score = wireCongestion_[wire.first];
+            auto fnd = wireSlots_.find(wire.first);
+            if (fnd != wireSlots_.end())
+                rendererData_->chunks.at(fnd->second.chunk).congestion += wire.second - score;
+            score = wire.second;
+        }
+    }
+
+    // Summaries are cheap to build from the chunks, so are built again
+    // whenever anything changed.
+    if (fullReload || !decals.empty() || !congestion.empty()) {
+        LineShaderData heatmap[heatmapLevels_], congestionMap[heatmapLevels_];
+        // Only this thread changes the chunks, so reading them without the
+        // lock is fine.
+        renderHeatmap(rendererData_->chunks, heatmap);
+        renderCongestion(rendererData_->chunks, congestionMap);
+
+        QMutexLocker lock(&rendererDataLock_);
+        for (int i = 0; i < heatmapLevels_; i++) {
+            rendererData_->gfxHeatmap[i] = std::move(heatmap[i]);
+            rendererData_->gfxCongestion[i] = std::move(congestionMap[i]);
+        }
+    }
 
     if (highlightedOrSelectedChanged) {
+        // Selections are made on the main thread and may name decals no
+        // object was published with, so fetch the graphics of those first.
+        std::vector<DecalXY> argDecals(selectedDecals);
+        argDecals.push_back(hoveredDecal);
+        for (int i = 0; i < 8; i++)
+            argDecals.insert(argDecals.end(), highlightedDecals[i].begin(), highlightedDecals[i].end());
+        std::vector<DecalId> missing;
+        for (auto &decal : argDecals) {
+            if (decal.decal != DecalId() && !rendererData_->decalGraphics.count(decal.decal))
+                missing.push_back(decal.decal);
+        }
+        DecalGraphics argGraphics;
+        if (!missing.empty()) {
+            ctx_->lock_ui();
+            for (auto decal : missing)
+                queryDecalGraphics(argGraphics, decal);
+            ctx_->unlock_ui();
+        }
+
         QMutexLocker locker(&rendererDataLock_);
+        for (auto &decal : argGraphics)
+            rendererData_->decalGraphics[decal.first] = std::move(decal.second);
 
         // Whether the currently being hovered decal is also selected.
         bool hoveringSelected = false;
@@ -551,14 +870,14 @@ void FPGAViewWidget::renderLines(void)
         for (auto &decal : selectedDecals) {
             if (decal == hoveredDecal)
                 hoveringSelected = true;
-            renderDecal(rendererData_->gfxSelected, rendererData_->bbSelected, decal);
+            renderDecal(rendererData_->gfxSelected, rendererData_->bbSelected, rendererData_->decalGraphics, decal);
         }
         rendererData_->gfxSelected.last_render++;
 
         // Render hovered.
         rendererData_->gfxHovered.clear();
         if (!hoveringSelected) {
-            renderDecal(rendererData_->gfxHovered, rendererData_->bbGlobal, hoveredDecal);
+            renderDecal(rendererData_->gfxHovered, rendererData_->bbGlobal, rendererData_->decalGraphics, hoveredDecal);
         }
         rendererData_->gfxHovered.last_render++;
 
@@ -566,7 +885,8 @@ void FPGAViewWidget::renderLines(void)
         for (int i = 0; i < 8; i++) {
             rendererData_->gfxHighlighted[i].clear();
             for (auto &decal : highlightedDecals[i]) {
-                renderDecal(rendererData_->gfxHighlighted[i], rendererData_->bbGlobal, decal);
+                renderDecal(rendererData_->gfxHighlighted[i], rendererData_->bbGlobal, rendererData_->decalGraphics,
+                            decal);
             }
             rendererData_->gfxHighlighted[i].last_render++;
         }
@@ -614,27 +934,30 @@ void FPGAViewWidget::resizeGL(int width, int height) {}
 
 boost::optional<FPGAViewWidget::PickedElement> FPGAViewWidget::pickElement(float worldx, float worldy)
 {
-    // Get elements from renderer whose BBs correspond to the pick.
+    // Get elements from renderer whose BBs correspond to the pick, and
+    // calculate distances to all of them from the rendered graphics.
     std::vector<PickedElement> elems;
+    using ElemDist = std::pair<const PickedElement *, float>;
+    std::vector<ElemDist> distances;
     {
         QMutexLocker locker(&rendererDataLock_);
-        if (rendererData_->qt == nullptr) {
-            return {};
+        for (auto const &chunk : rendererData_->chunks) {
+            if (chunk.qt == nullptr)
+                continue;
+            auto chunk_elems = chunk.qt->get(worldx, worldy);
+            std::copy(chunk_elems.begin(), chunk_elems.end(), std::back_inserter(elems));
         }
-        elems = rendererData_->qt->get(worldx, worldy);
+        std::transform(elems.begin(), elems.end(), std::back_inserter(distances),
+                       [&](const PickedElement &e) -> ElemDist {
+                           const auto &graphics = findGraphics(rendererData_->decalGraphics, e.decal.decal);
+                           return std::make_pair(&e, e.distance(graphics, worldx, worldy));
+                       });
     }
 
     if (elems.size() == 0) {
         return {};
     }
 
-    // Calculate distances to all elements picked.
-    using ElemDist = std::pair<const PickedElement *, float>;
-    std::vector<ElemDist> distances;
-    std::transform(elems.begin(), elems.end(), std::back_inserter(distances), [&](const PickedElement &e) -> ElemDist {
-        return std::make_pair(&e, e.distance(ctx_, worldx, worldy));
-    });
-
     // Find closest non -1 element.
     auto closest = std::min_element(distances.begin(), distances.end(), [&](const ElemDist &a, const ElemDist &b) {
         if (a.second == -1)
@@ -721,7 +1044,7 @@ void FPGAViewWidget::mouseMoveEvent(QMouseEvent *event)
 
     {
         QMutexLocker locked(&rendererArgsLock_);
-        rendererArgs_->hoveredDecal = closest.decal(ctx_);
+        rendererArgs_->hoveredDecal = closest.decal;
         rendererArgs_->changed = true;
         rendererArgs_->x = event->x();
         rendererArgs_->y = event->y();
@@ -874,13 +1197,48 @@ void FPGAViewWidget::leaveEvent(QEvent *event)
     pokeRenderer();
 }
 
+void FPGAViewWidget::updateVisibleChunks()
+{
+    auto &chunks = rendererData_->chunks;
+    visibleChunks_.assign(chunks.size(), false);
+    // In the low zoom summary no chunk is drawn in full.
+    if (lodActive_)
+        return;
+
+    // Find the world area in the viewport, with a chunk of margin.
+    const qreal retinaScale = devicePixelRatio();
+    QVector4D corner0 = mouseToWorldCoordinates(0, 0);
+    QVector4D corner1 = mouseToWorldCoordinates(width() * retinaScale, height() * retinaScale);
+    float x0 = std::min(corner0.x(), corner1.x()) - chunkSize_;
+    float y0 = std::min(corner0.y(), corner1.y()) - chunkSize_;
+    float x1 = std::max(corner0.x(), corner1.x()) + chunkSize_;
+    float y1 = std::max(corner0.y(), corner1.y()) + chunkSize_;
+
+    for (size_t i = 0; i < chunks.size(); i++) {
+        auto &bb = chunks.at(i).bb;
+        if (bb.w() < 0 || bb.h() < 0)
+            continue;
+        visibleChunks_.at(i) = bb.x1() >= x0 && bb.x0() <= x1 && bb.y1() >= y0 && bb.y0() <= y1;
+    }
+}
+
 void FPGAViewWidget::update_vbos()
 {
+    // Chunks out of view are not uploaded until they come into view.
     for (int style = GraphicElement::STYLE_FRAME; style
                   < GraphicElement::STYLE_HIGHLIGHTED0;
                                              style++) {
-        lineShader_.update_vbos((enum GraphicElement::style_t)(style),
-                                    rendererData_->gfxByStyle[style]);
+        std::vector<const LineShaderData *> chunks;
+        for (size_t i = 0; i < rendererData_->chunks.size(); i++) {
+            auto &chunk = rendererData_->chunks.at(i);
+            chunks.push_back(visibleChunks_.at(i) ? &chunk.gfxByStyle[style] : nullptr);
+        }
+        lineShader_.update_vbos((enum GraphicElement::style_t)(style), chunks);
+    }
+
+    for (int i = 0; i < heatmapLevels_; i++) {
+        lineShader_.update_layer_vbos(i, rendererData_->gfxHeatmap[i]);
+        lineShader_.update_layer_vbos(heatmapLevels_ + i, rendererData_->gfxCongestion[i]);
     }
 
     for (int i = 0; i < 8; i++) {
@@ -32,6 +32,7 @@
 #include <QTimer>
 #include <QWaitCondition>
 #include <boost/optional.hpp>
+#include <map>
 
 #include "designwidget.h"
 #include "lineshader.h"
@@ -144,36 +145,37 @@ class FPGAViewWidget : public QOpenGLWidget, protected QOpenGLFunctions
         PipId pip;
         GroupId group;
 
-        float x, y; // Decal X and Y
+        // Decal of the element when it was last rendered.
+        DecalXY decal;
 
-        PickedElement(ElementType type, float x, float y) : type(type), x(x), y(y) {}
+        PickedElement(ElementType type, const DecalXY &decal) : type(type), decal(decal) {}
 
-        static PickedElement fromBel(BelId bel, float x, float y)
+        static PickedElement fromBel(BelId bel, const DecalXY &decal = DecalXY())
         {
-            PickedElement e(ElementType::BEL, x, y);
+            PickedElement e(ElementType::BEL, decal);
             e.bel = bel;
             return e;
         }
-        static PickedElement fromWire(WireId wire, float x, float y)
+        static PickedElement fromWire(WireId wire, const DecalXY &decal = DecalXY())
         {
-            PickedElement e(ElementType::WIRE, x, y);
+            PickedElement e(ElementType::WIRE, decal);
             e.wire = wire;
             return e;
         }
-        static PickedElement fromPip(PipId pip, float x, float y)
+        static PickedElement fromPip(PipId pip, const DecalXY &decal = DecalXY())
         {
-            PickedElement e(ElementType::PIP, x, y);
+            PickedElement e(ElementType::PIP, decal);
             e.pip = pip;
             return e;
         }
-        static PickedElement fromGroup(GroupId group, float x, float y)
+        static PickedElement fromGroup(GroupId group, const DecalXY &decal = DecalXY())
         {
-            PickedElement e(ElementType::GROUP, x, y);
+            PickedElement e(ElementType::GROUP, decal);
             e.group = group;
             return e;
         }
 
-        PickedElement(const PickedElement &other) : type(other.type)
+        PickedElement(const PickedElement &other) : type(other.type), decal(other.decal)
         {
             switch (type) {
             case ElementType::BEL:
@@ -193,30 +195,10 @@ class FPGAViewWidget : public QOpenGLWidget, protected QOpenGLFunctions
             }
         }
 
-        DecalXY decal(Context *ctx) const
-        {
-            DecalXY decal;
-            switch (type) {
-            case ElementType::BEL:
-                decal = ctx->getBelDecal(bel);
-                break;
-            case ElementType::WIRE:
-                decal = ctx->getWireDecal(wire);
-                break;
-            case ElementType::PIP:
-                decal = ctx->getPipDecal(pip);
-                break;
-            case ElementType::GROUP:
-                decal = ctx->getGroupDecal(group);
-                break;
-            default:
-                NPNR_ASSERT_FALSE("Invalid ElementType");
-            }
-            return decal;
-        }
-        float distance(Context *ctx, float wx, float wy) const;
+        float distance(const std::vector<GraphicElement> &graphics, float wx, float wy) const;
     };
     using PickQuadTree = QuadTree<float, PickedElement>;
+    using DecalGraphics = std::unordered_map<DecalId, std::vector<GraphicElement>>;
 
     Context *ctx_;
     QTimer paintTimer_;
@@ -237,6 +219,7 @@ class FPGAViewWidget : public QOpenGLWidget, protected QOpenGLFunctions
         QColor active;
         QColor selected;
         QColor hovered;
+        QColor congestion;
         QColor highlight[8];
     } colors_;
 
@@ -276,9 +259,41 @@ class FPGAViewWidget : public QOpenGLWidget, protected QOpenGLFunctions
     std::unique_ptr<RendererArgs> rendererArgs_;
     QMutex rendererArgsLock_;
 
-    struct RendererData
+    // Arch decals are split into chunks by location, so that when a few
+    // objects change state only the chunks containing them are rendered,
+    // uploaded and added to a picking quadtree again.
+    struct RendererChunk
     {
         LineShaderData gfxByStyle[GraphicElement::STYLE_MAX];
+        // Bounding box of data in this chunk.
+        PickQuadTree::BoundingBox bb;
+        // Quadtree for picking objects in this chunk.
+        std::unique_ptr<PickQuadTree> qt;
+        // Location of this chunk, in units of chunkSize_.
+        std::pair<int, int> loc;
+        // Number of objects in this chunk, and how many of them are in use,
+        // for the low zoom summary.
+        int objects = 0;
+        int active = 0;
+        // Sum of the routing congestion scores of wires in this chunk.
+        int congestion = 0;
+    };
+    // Width and height of a chunk, in world units.
+    const float chunkSize_ = 8.0f;
+    // When a chunk is smaller than this many pixels on screen, only a
+    // summary of its utilisation is drawn instead of its decals.
+    const float lodChunkPixels_ = 24.0f;
+    // Number of utilisation levels in the low zoom summary.
+    static constexpr int heatmapLevels_ = 8;
+
+    struct RendererData
+    {
+        std::vector<RendererChunk> chunks;
+        // Low zoom summary of the chunks, one cell per chunk, by utilisation.
+        LineShaderData gfxHeatmap[heatmapLevels_];
+        // Routing congestion overlay, one outline per congested chunk, by
+        // congestion relative to the most congested chunk.
+        LineShaderData gfxCongestion[heatmapLevels_];
         LineShaderData gfxSelected;
         LineShaderData gfxHovered;
         LineShaderData gfxHighlighted[8];
@@ -286,28 +301,65 @@ class FPGAViewWidget : public QOpenGLWidget, protected QOpenGLFunctions
         PickQuadTree::BoundingBox bbGlobal;
         // Bounding box of selected items.
         PickQuadTree::BoundingBox bbSelected;
-        // Quadtree for picking objects.
-        std::unique_ptr<PickQuadTree> qt;
         // Flags from args.
         PassthroughFlags flags;
+        // Graphics of the decals of the objects in the chunks, and of the
+        // selected, hovered and highlighted decals, so that neither
+        // rendering nor picking has to call into the Arch.
+        DecalGraphics decalGraphics;
     };
     std::unique_ptr<RendererData> rendererData_;
     QMutex rendererDataLock_;
 
+    // Objects in each chunk with their current decals, and the position of
+    // each object in them. Only used by the renderer thread.
+    using ChunkObjects = std::vector<PickedElement>;
+    struct ChunkSlot
+    {
+        int chunk, index;
+    };
+    std::vector<ChunkObjects> chunkObjects_;
+    std::unordered_map<BelId, ChunkSlot> belSlots_;
+    std::unordered_map<WireId, ChunkSlot> wireSlots_;
+    std::unordered_map<PipId, ChunkSlot> pipSlots_;
+    std::unordered_map<GroupId, ChunkSlot> groupSlots_;
+    // Last routing congestion score received for each wire.
+    std::unordered_map<WireId, int> wireCongestion_;
+    int lastRender_ = 0;
+
+    // Chunks currently in the viewport, and whether they are drawn as a
+    // summary. Only used by the main thread.
+    std::vector<bool> visibleChunks_;
+    bool lodActive_ = false;
+
     void clampZoom();
     void zoomToBB(const PickQuadTree::BoundingBox &bb, float margin, bool clamp);
     void zoom(int level);
     void renderLines(void);
     void renderGraphicElement(LineShaderData &out, PickQuadTree::BoundingBox &bb, const GraphicElement &el, float x,
                               float y);
-    void renderDecal(LineShaderData &out, PickQuadTree::BoundingBox &bb, const DecalXY &decal);
+    void renderDecal(LineShaderData &out, PickQuadTree::BoundingBox &bb, const DecalGraphics &graphics,
+                     const DecalXY &decal);
     void renderArchDecal(LineShaderData out[GraphicElement::STYLE_MAX], PickQuadTree::BoundingBox &bb,
-                         const DecalXY &decal);
-    void populateQuadTree(RendererData *data, const DecalXY &decal, const PickedElement &element);
+                         const DecalXY &decal, const std::vector<GraphicElement> &graphics);
+    void renderChunk(const ChunkObjects &objects, const DecalGraphics &graphics, RendererChunk &chunk);
+    void renderHeatmap(const std::vector<RendererChunk> &chunks, LineShaderData out[heatmapLevels_]);
+    void renderCongestion(const std::vector<RendererChunk> &chunks, LineShaderData out[heatmapLevels_]);
+    void populateQuadTree(std::vector<std::pair<PickQuadTree::BoundingBox, PickedElement>> &elems,
+                          const DecalGraphics &graphics, const PickedElement &element);
+    void populateChunkQuadTree(const ChunkObjects &objects, const DecalGraphics &graphics, RendererChunk &chunk);
+    ChunkSlot *findSlot(const PickedElement &element);
+    DecalXY queryDecal(const PickedElement &element);
+    void queryDecalGraphics(DecalGraphics &graphics, DecalId decal);
+    std::pair<int, int> chunkLocation(const DecalGraphics &graphics, const DecalXY &decal) const;
+    void addChunkObject(const PickedElement &element, std::pair<int, int> loc,
+                        std::map<std::pair<int, int>, int> &chunkByLoc, RendererData *data);
+    void reloadAll(RendererData *data);
     boost::optional<PickedElement> pickElement(float worldx, float worldy);
     QVector4D mouseToWorldCoordinates(int x, int y);
     QVector4D mouseToWorldDimensions(float x, float y);
     QMatrix4x4 getProjection(void);
+    void updateVisibleChunks();
     void update_vbos();
 };
 
@@ -172,97 +172,165 @@ bool LineShader::compile(void)
     program_->release();
 
     for (int style = 0; style < GraphicElement::STYLE_MAX; style++) {
-        buffers_[style].position = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-        buffers_[style].normal = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-        buffers_[style].miter = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-        buffers_[style].index = QOpenGLBuffer(QOpenGLBuffer::IndexBuffer);
-
-        if (!buffers_[style].vao.create())
+        if (!createBuffers(buffers_[style]))
             log_abort();
-        buffers_[style].vao.bind();
+    }
 
-        if (!buffers_[style].position.create())
-            log_abort();
-        if (!buffers_[style].normal.create())
-            log_abort();
-        if (!buffers_[style].miter.create())
-            log_abort();
-        if (!buffers_[style].index.create())
-            log_abort();
+    return true;
+}
 
-        buffers_[style].position.setUsagePattern(QOpenGLBuffer::StaticDraw);
-        buffers_[style].normal.setUsagePattern(QOpenGLBuffer::StaticDraw);
-        buffers_[style].miter.setUsagePattern(QOpenGLBuffer::StaticDraw);
-        buffers_[style].index.setUsagePattern(QOpenGLBuffer::StaticDraw);
+bool LineShader::createBuffers(Buffers &buffers)
+{
+    buffers.position = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+    buffers.normal = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+    buffers.miter = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+    buffers.index = QOpenGLBuffer(QOpenGLBuffer::IndexBuffer);
 
-        buffers_[style].position.bind();
-        buffers_[style].normal.bind();
-        buffers_[style].miter.bind();
-        buffers_[style].index.bind();
+    if (!buffers.vao.create())
+        return false;
+    buffers.vao.bind();
 
-        buffers_[style].vao.release();
-    }
+    if (!buffers.position.create())
+        return false;
+    if (!buffers.normal.create())
+        return false;
+    if (!buffers.miter.create())
+        return false;
+    if (!buffers.index.create())
+        return false;
+
+    buffers.position.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    buffers.normal.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    buffers.miter.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    buffers.index.setUsagePattern(QOpenGLBuffer::StaticDraw);
 
+    buffers.position.bind();
+    buffers.normal.bind();
+    buffers.miter.bind();
+    buffers.index.bind();
+
+    buffers.vao.release();
     return true;
 }
 
-void LineShader::update_vbos(enum GraphicElement::style_t style,
-                                     const LineShaderData &line)
+void LineShader::updateBuffers(Buffers &buffers, const LineShaderData &line)
 {
-    if (buffers_[style].last_vbo_update == line.last_render)
+    if (buffers.last_vbo_update == line.last_render)
         return;
-    buffers_[style].last_vbo_update = line.last_render;
+    buffers.last_vbo_update = line.last_render;
 
-    buffers_[style].indices = line.indices.size();
-    if (buffers_[style].indices == 0)
+    buffers.indices = line.indices.size();
+    if (buffers.indices == 0)
         return;
 
-    buffers_[style].position.bind();
-    buffers_[style].position.allocate(&line.vertices[0], sizeof(Vertex2DPOD) * line.vertices.size());
+    buffers.position.bind();
+    buffers.position.allocate(&line.vertices[0], sizeof(Vertex2DPOD) * line.vertices.size());
 
-    buffers_[style].normal.bind();
-    buffers_[style].normal.allocate(&line.normals[0], sizeof(Vertex2DPOD) * line.normals.size());
+    buffers.normal.bind();
+    buffers.normal.allocate(&line.normals[0], sizeof(Vertex2DPOD) * line.normals.size());
 
-    buffers_[style].miter.bind();
-    buffers_[style].miter.allocate(&line.miters[0], sizeof(GLfloat) * line.miters.size());
+    buffers.miter.bind();
+    buffers.miter.allocate(&line.miters[0], sizeof(GLfloat) * line.miters.size());
 
-    buffers_[style].index.bind();
-    buffers_[style].index.allocate(&line.indices[0], sizeof(GLuint) * line.indices.size());
+    buffers.index.bind();
+    buffers.index.allocate(&line.indices[0], sizeof(GLuint) * line.indices.size());
 }
 
-void LineShader::draw(enum GraphicElement::style_t style, const QColor &color,
-                                float thickness, const QMatrix4x4 &projection)
+void LineShader::update_vbos(enum GraphicElement::style_t style,
+                                     const LineShaderData &line)
+{
+    updateBuffers(buffers_[style], line);
+}
+
+void LineShader::update_vbos(enum GraphicElement::style_t style,
+                                     const std::vector<const LineShaderData *> &chunks)
+{
+    auto &buffers = chunkBuffers_[style];
+    if (buffers.size() > chunks.size())
+        buffers.resize(chunks.size());
+    while (buffers.size() < chunks.size()) {
+        buffers.push_back(std::unique_ptr<Buffers>(new Buffers));
+        if (!createBuffers(*buffers.back()))
+            log_abort();
+    }
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (chunks.at(i) != nullptr)
+            updateBuffers(*buffers.at(i), *chunks.at(i));
+    }
+}
+
+void LineShader::update_layer_vbos(int layer, const LineShaderData &line)
+{
+    while (int(layerBuffers_.size()) <= layer) {
+        layerBuffers_.push_back(std::unique_ptr<Buffers>(new Buffers));
+        if (!createBuffers(*layerBuffers_.back()))
+            log_abort();
+    }
+    updateBuffers(*layerBuffers_.at(layer), line);
+}
+
+void LineShader::drawBuffers(Buffers &buffers)
 {
     auto gl = QOpenGLContext::currentContext()->functions();
-    if (buffers_[style].indices == 0)
+    if (buffers.indices == 0)
         return;
-    program_->bind();
-    buffers_[style].vao.bind();
-
-    program_->setUniformValue(uniforms_.projection, projection);
-    program_->setUniformValue(uniforms_.thickness, thickness);
-    program_->setUniformValue(uniforms_.color, color.redF(), color.greenF(), color.blueF(), color.alphaF());
+    buffers.vao.bind();
 
-    buffers_[style].position.bind();
+    buffers.position.bind();
     program_->enableAttributeArray(attributes_.position);
     program_->setAttributeBuffer(attributes_.position, GL_FLOAT, 0, 2);
 
-    buffers_[style].normal.bind();
+    buffers.normal.bind();
     program_->enableAttributeArray(attributes_.normal);
     program_->setAttributeBuffer(attributes_.normal, GL_FLOAT, 0, 2);
 
-    buffers_[style].miter.bind();
+    buffers.miter.bind();
     program_->enableAttributeArray(attributes_.miter);
     program_->setAttributeBuffer(attributes_.miter, GL_FLOAT, 0, 1);
 
-    buffers_[style].index.bind();
-    gl->glDrawElements(GL_TRIANGLES, buffers_[style].indices, GL_UNSIGNED_INT, (void *)0);
+    buffers.index.bind();
+    gl->glDrawElements(GL_TRIANGLES, buffers.indices, GL_UNSIGNED_INT, (void *)0);
 
     program_->disableAttributeArray(attributes_.position);
     program_->disableAttributeArray(attributes_.normal);
     program_->disableAttributeArray(attributes_.miter);
 
-    buffers_[style].vao.release();
+    buffers.vao.release();
+}
+
+void LineShader::setUniforms(const QColor &color, float thickness, const QMatrix4x4 &projection)
+{
+    program_->setUniformValue(uniforms_.projection, projection);
+    program_->setUniformValue(uniforms_.thickness, thickness);
+    program_->setUniformValue(uniforms_.color, color.redF(), color.greenF(), color.blueF(), color.alphaF());
+}
+
+void LineShader::draw(enum GraphicElement::style_t style, const QColor &color,
+                                float thickness, const QMatrix4x4 &projection,
+                                const std::vector<bool> *visible)
+{
+    if (buffers_[style].indices == 0 && chunkBuffers_[style].empty())
+        return;
+    program_->bind();
+    setUniforms(color, thickness, projection);
+
+    drawBuffers(buffers_[style]);
+    auto &chunks = chunkBuffers_[style];
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (visible == nullptr || (i < visible->size() && visible->at(i)))
+            drawBuffers(*chunks.at(i));
+    }
+
+    program_->release();
+}
+
+void LineShader::draw_layer(int layer, const QColor &color, float thickness, const QMatrix4x4 &projection)
+{
+    if (layer >= int(layerBuffers_.size()) || layerBuffers_.at(layer)->indices == 0)
+        return;
+    program_->bind();
+    setUniforms(color, thickness, projection);
+    drawBuffers(*layerBuffers_.at(layer));
     program_->release();
 }
 
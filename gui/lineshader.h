@@ -21,6 +21,7 @@
 #define LINESHADER_H
 
 #include <array>
+#include <memory>
 #include <QOpenGLBuffer>
 #include <QOpenGLFunctions>
 #include <QOpenGLShaderProgram>
@@ -156,6 +157,11 @@ class LineShader
         int last_vbo_update = 0;
     };
     std::array<Buffers, GraphicElement::STYLE_MAX> buffers_;
+    // Buffers for styles whose data is split into independently updated
+    // chunks, see update_vbos.
+    std::array<std::vector<std::unique_ptr<Buffers>>, GraphicElement::STYLE_MAX> chunkBuffers_;
+    // Buffers for data not tied to an Arch style, see update_layer_vbos.
+    std::vector<std::unique_ptr<Buffers>> layerBuffers_;
 
     // GL uniform locations.
     struct
@@ -168,6 +174,11 @@ class LineShader
         GLuint color;
     } uniforms_;
 
+    bool createBuffers(Buffers &buffers);
+    void updateBuffers(Buffers &buffers, const LineShaderData &line);
+    void drawBuffers(Buffers &buffers);
+    void setUniforms(const QColor &color, float thickness, const QMatrix4x4 &projection);
+
   public:
     LineShader(QObject *parent) : parent_(parent), program_(nullptr)
     {
@@ -197,9 +208,26 @@ class LineShader
     void update_vbos(enum GraphicElement::style_t style,
                             const LineShaderData &line);
 
-    // Render a LineShaderData with a given M/V/P transformation.
+    // Upload data for a style that is split into chunks. Each chunk has its
+    // own buffers, and is only uploaded again if its last_render changed.
+    // Null chunks are not uploaded, which is used to defer uploading chunks
+    // that are not visible. Buffers of chunks past the end of the given list
+    // are freed.
+    void update_vbos(enum GraphicElement::style_t style,
+                            const std::vector<const LineShaderData *> &chunks);
+
+    // Upload data for an extra layer, such as a low zoom summary, that is
+    // drawn with draw_layer. Layers are numbered from zero.
+    void update_layer_vbos(int layer, const LineShaderData &line);
+
+    // Render a LineShaderData with a given M/V/P transformation. If visible
+    // is given, only the chunks marked in it are rendered.
     void draw(enum GraphicElement::style_t style, const QColor &color,
-                       float thickness, const QMatrix4x4 &projection);
+                       float thickness, const QMatrix4x4 &projection,
+                       const std::vector<bool> *visible = nullptr);
+
+    // Render an extra layer with a given M/V/P transformation.
+    void draw_layer(int layer, const QColor &color, float thickness, const QMatrix4x4 &projection);
 };
 
 NEXTPNR_NAMESPACE_END
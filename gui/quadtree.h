@@ -206,6 +206,30 @@ template <typename CoordinateT, typename ElementT> class QuadTreeNode
         return true;
     }
 
+    // Create children, splitting this node's bounding box into four.
+    void split()
+    {
+        // Calculate the split point.
+        splitx_ = (bound_.x1_ - bound_.x0_) / 2 + bound_.x0_;
+        splity_ = (bound_.y1_ - bound_.y0_) / 2 + bound_.y0_;
+        // Create the new children.
+        children_ = decltype(children_)(new QuadTreeNode<CoordinateT, ElementT>[4] {
+            // Note: not using [NW] = QuadTreeNode because that seems to
+            //       crash g++ 7.3.0.
+            /* NW */ QuadTreeNode<CoordinateT, ElementT>(BoundingBox(bound_.x0_, bound_.y0_, splitx_, splity_),
+                                                         depth_ + 1, max_elems_),
+                    /* NE */
+                    QuadTreeNode<CoordinateT, ElementT>(BoundingBox(splitx_, bound_.y0_, bound_.x1_, splity_),
+                                                        depth_ + 1, max_elems_),
+                    /* SW */
+                    QuadTreeNode<CoordinateT, ElementT>(BoundingBox(bound_.x0_, splity_, splitx_, bound_.y1_),
+                                                        depth_ + 1, max_elems_),
+                    /* SE */
+                    QuadTreeNode<CoordinateT, ElementT>(BoundingBox(splitx_, splity_, bound_.x1_, bound_.y1_),
+                                                        depth_ + 1, max_elems_),
+        });
+    }
+
   public:
     // Standard constructor for node.
     // @param b BoundingBox this node covers.
@@ -262,25 +286,7 @@ template <typename CoordinateT, typename ElementT> class QuadTreeNode
                 elems_.push_back(BoundElement(k, std::move(v)));
                 return true;
             }
-            // Splitting. Calculate the split point.
-            splitx_ = (bound_.x1_ - bound_.x0_) / 2 + bound_.x0_;
-            splity_ = (bound_.y1_ - bound_.y0_) / 2 + bound_.y0_;
-            // Create the new children.
-            children_ = decltype(children_)(new QuadTreeNode<CoordinateT, ElementT>[4] {
-                // Note: not using [NW] = QuadTreeNode because that seems to
-                //       crash g++ 7.3.0.
-                /* NW */ QuadTreeNode<CoordinateT, ElementT>(BoundingBox(bound_.x0_, bound_.y0_, splitx_, splity_),
-                                                             depth_ + 1, max_elems_),
-                        /* NE */
-                        QuadTreeNode<CoordinateT, ElementT>(BoundingBox(splitx_, bound_.y0_, bound_.x1_, splity_),
-                                                            depth_ + 1, max_elems_),
-                        /* SW */
-                        QuadTreeNode<CoordinateT, ElementT>(BoundingBox(bound_.x0_, splity_, splitx_, bound_.y1_),
-                                                            depth_ + 1, max_elems_),
-                        /* SE */
-                        QuadTreeNode<CoordinateT, ElementT>(BoundingBox(splitx_, splity_, bound_.x1_, bound_.y1_),
-                                                            depth_ + 1, max_elems_),
-            });
+            split();
             // Move all elements to where they belong.
             auto it = elems_.begin();
             while (it != elems_.end()) {
@@ -302,6 +308,54 @@ template <typename CoordinateT, typename ElementT> class QuadTreeNode
         return true;
     }
 
+    // Insert many elements at once. Rather than splitting nodes as they fill
+    // up and moving their elements down, which copies elements repeatedly,
+    // elements are partitioned top-down straight into the node they belong
+    // to. The resulting tree is the same shape as with repeated insert.
+    bool bulk_insert(std::vector<std::pair<BoundingBox, ElementT>> &elems)
+    {
+        std::vector<BoundElement> bound;
+        bound.reserve(elems.size());
+        for (auto &elem : elems)
+            bound.push_back(BoundElement(elem.first, std::move(elem.second)));
+        return bulk_insert_bound(bound);
+    }
+
+  private:
+    bool bulk_insert_bound(std::vector<BoundElement> &elems)
+    {
+        for (const auto &elem : elems) {
+            if (!fits(elem.bb_))
+                return false;
+        }
+
+        if (children_ == nullptr) {
+            if (elems_.size() + elems.size() <= max_elems_ || depth_ > 5) {
+                std::move(elems.begin(), elems.end(), std::back_inserter(elems_));
+                return true;
+            }
+            split();
+            // Our own elements get distributed along with the new ones.
+            std::move(elems_.begin(), elems_.end(), std::back_inserter(elems));
+            elems_.clear();
+        }
+
+        std::vector<BoundElement> quads[4];
+        for (auto &elem : elems) {
+            auto quad = quadrant(elem.bb_);
+            if (quad == THIS_NODE)
+                elems_.push_back(std::move(elem));
+            else
+                quads[quad].push_back(std::move(elem));
+        }
+        for (int i = 0; i < 4; i++) {
+            if (!quads[i].empty() && !children_[i].bulk_insert_bound(quads[i]))
+                return false;
+        }
+        return true;
+    }
+
+  public:
     // Dump a human-readable representation of the tree to stdout.
     void dump(int level) const
     {
@@ -399,6 +453,19 @@ template <typename CoordinateT, typename ElementT> class QuadTree
         return root_.insert(k, v);
     }
 
+    // Inserts many values at once, which is much faster than inserting them
+    // one at a time when building a large tree.
+    //
+    // @param elems Bounding boxes and the values to store at them.
+    // @returns Whether all elements fit in the tree. If not, none are
+    //          inserted.
+    bool bulk_insert(std::vector<std::pair<BoundingBox, ElementT>> elems)
+    {
+        for (auto &elem : elems)
+            elem.first.fixup();
+        return root_.bulk_insert(elems);
+    }
+
     // Dump a human-readable representation of the tree to stdout.
     void dump() const { root_.dump(0); }
 
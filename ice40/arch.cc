@@ -22,6 +22,7 @@
 #include <cmath>
 #include "cells.h"
 #include "gfx.h"
+#include "globals.h"
 #include "log.h"
 #include "nextpnr.h"
 #include "placer1.h"
@@ -88,6 +89,7 @@ Arch::Arch(ArchArgs args) : args(args)
     if (package_info == nullptr)
         log_error("Unsupported package '%s'.\n", args.package.c_str());
 
+    logic_tiles.resize(chip_info->width * chip_info->height);
     bel_carry.resize(chip_info->num_bels);
     bel_to_cell.resize(chip_info->num_bels);
     wire_to_net.resize(chip_info->num_wires);
@@ -609,7 +611,12 @@ bool Arch::getBudgetOverride(const NetInfo *net_info, const PortRef &sink, delay
 
 bool Arch::place() { return placer1(getCtx(), Placer1Cfg(getCtx())); }
 
-bool Arch::route() { return router1(getCtx(), Router1Cfg(getCtx())); }
+bool Arch::route()
+{
+    if (Settings(getCtx()).get<bool>("route/ice40Globals", true))
+        route_ice40_globals(getCtx());
+    return router1(getCtx(), Router1Cfg(getCtx()));
+}
 
 // -----------------------------------------------------------------------
 
@@ -961,6 +968,12 @@ void Arch::assignArchInfo()
         CellInfo *ci = cell.second.get();
         assignCellInfo(ci);
     }
+    // Logic cells that are already bound may have changed
+    for (auto &cell : getCtx()->cells) {
+        CellInfo *ci = cell.second.get();
+        if (ci->type == id_ICESTORM_LC && ci->bel != BelId())
+            rebuildLogicTile(ci->bel);
+    }
 }
 
 void Arch::assignCellInfo(CellInfo *cell)
@@ -400,6 +400,21 @@ struct Arch : BaseCtx
     mutable std::unordered_map<IdString, int> pip_by_name;
     mutable std::unordered_map<Loc, int> bel_by_loc;
 
+    // Summary of the logic cells bound in each tile, maintained by bindBel and
+    // unbindBel so that logic cell validity checks need not visit the tile
+    struct LogicTileState
+    {
+        // Number of bound cells with a DFF, which share the control set below
+        // unless conflict is set
+        int dffs = 0;
+        bool conflict = false;
+        bool neg_clk = false;
+        const NetInfo *cen = nullptr, *clk = nullptr, *sr = nullptr;
+        // Local routing inputs used by the control set and the LUT inputs
+        int ctrl_locals = 0, lut_inputs = 0;
+    };
+
+    std::vector<LogicTileState> logic_tiles;
     std::vector<bool> bel_carry;
     std::vector<CellInfo *> bel_to_cell;
     std::vector<NetInfo *> wire_to_net;
@@ -414,6 +429,8 @@ struct Arch : BaseCtx
     IdString archId() const { return id("ice40"); }
     ArchArgs archArgs() const { return args; }
     IdString archArgsToId(ArchArgs args) const;
+    // The device is entirely determined by the ArchArgs.
+    void copyDeviceFrom(const Arch &other) {}
 
     // -------------------------------------------------
 
@@ -441,6 +458,8 @@ struct Arch : BaseCtx
 
         bel_to_cell[bel.index] = cell;
         bel_carry[bel.index] = (cell->type == id_ICESTORM_LC && cell->lcInfo.carryEnable);
+        if (cell->type == id_ICESTORM_LC)
+            bindLogicTile(bel, cell);
         cell->bel = bel;
         cell->belStrength = strength;
         refreshUiBel(bel);
@@ -450,10 +469,13 @@ struct Arch : BaseCtx
     {
         NPNR_ASSERT(bel != BelId());
         NPNR_ASSERT(bel_to_cell[bel.index] != nullptr);
-        bel_to_cell[bel.index]->bel = BelId();
-        bel_to_cell[bel.index]->belStrength = STRENGTH_NONE;
+        CellInfo *cell = bel_to_cell[bel.index];
+        cell->bel = BelId();
+        cell->belStrength = STRENGTH_NONE;
         bel_to_cell[bel.index] = nullptr;
         bel_carry[bel.index] = false;
+        if (cell->type == id_ICESTORM_LC)
+            unbindLogicTile(bel, cell);
         refreshUiBel(bel);
     }
 
@@ -539,6 +561,7 @@ struct Arch : BaseCtx
         NPNR_ASSERT(wire != WireId());
         NPNR_ASSERT(wire_to_net[wire.index] != nullptr);
 
+        wire_to_net[wire.index]->route_gen++;
         auto &net_wires = wire_to_net[wire.index]->wires;
         auto it = net_wires.find(wire);
         NPNR_ASSERT(it != net_wires.end());
@@ -634,6 +657,7 @@ struct Arch : BaseCtx
         NPNR_ASSERT(wire_to_net[dst.index] != nullptr);
         wire_to_net[dst.index] = nullptr;
         pip_to_net[pip.index]->wires.erase(dst);
+        pip_to_net[pip.index]->route_gen++;
 
         pip_to_net[pip.index] = nullptr;
         switches_locked[chip_info->pip_data[pip.index].switch_index] = nullptr;
@@ -772,6 +796,7 @@ struct Arch : BaseCtx
 
     delay_t estimateDelay(WireId src, WireId dst) const;
     delay_t predictDelay(const NetInfo *net_info, const PortRef &sink) const;
+    delay_t predictDelay(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const;
     delay_t getDelayEpsilon() const { return 20; }
     delay_t getRipupDelayPenalty() const { return 200; }
     float getDelayNS(delay_t v) const { return v * 0.001; }
@@ -813,12 +838,29 @@ struct Arch : BaseCtx
     // such as conflicting set/reset signals, etc
     bool isValidBelForCell(CellInfo *cell, BelId bel) const;
 
+    // Whether or not a cell can be swapped with the cell bound to a Bel, or
+    // moved there if replaced is nullptr, without changing any bindings
+    bool isValidBelForCell(CellInfo *cell, BelId bel, CellInfo *replaced) const;
+
     // Return true whether all Bels at a given location are valid
     bool isBelLocationValid(BelId bel) const;
 
     // Helper function for above
     bool logicCellsCompatible(const CellInfo **it, const size_t size) const;
 
+    // Maintain logic_tiles as logic cells are bound and unbound
+    LogicTileState &getLogicTile(BelId bel)
+    {
+        return logic_tiles.at(chip_info->bel_data[bel.index].y * chip_info->width + chip_info->bel_data[bel.index].x);
+    }
+    const LogicTileState &getLogicTile(BelId bel) const
+    {
+        return logic_tiles.at(chip_info->bel_data[bel.index].y * chip_info->width + chip_info->bel_data[bel.index].x);
+    }
+    void bindLogicTile(BelId bel, const CellInfo *cell);
+    void unbindLogicTile(BelId bel, const CellInfo *cell);
+    void rebuildLogicTile(BelId bel);
+
     // -------------------------------------------------
     // Assign architecure-specific arguments to nets and cells, which must be
     // called between packing or further
@@ -70,18 +70,72 @@ bool Arch::logicCellsCompatible(const CellInfo **it, const size_t size) const
     return locals_count <= 32;
 }
 
+static int control_set_locals(const CellInfo *cell)
+{
+    int locals_count = 0;
+    if (cell->lcInfo.cen != nullptr && !cell->lcInfo.cen->is_global)
+        locals_count++;
+    if (cell->lcInfo.clk != nullptr && !cell->lcInfo.clk->is_global)
+        locals_count++;
+    if (cell->lcInfo.sr != nullptr && !cell->lcInfo.sr->is_global)
+        locals_count++;
+    return locals_count;
+}
+
+static bool same_control_set(const Arch::LogicTileState &ts, const CellInfo *cell)
+{
+    return ts.cen == cell->lcInfo.cen && ts.clk == cell->lcInfo.clk && ts.sr == cell->lcInfo.sr &&
+           ts.neg_clk == cell->lcInfo.negClk;
+}
+
+void Arch::bindLogicTile(BelId bel, const CellInfo *cell)
+{
+    LogicTileState &ts = getLogicTile(bel);
+    ts.lut_inputs += cell->lcInfo.inputCount;
+    if (cell->lcInfo.dffEnable) {
+        if (ts.dffs == 0) {
+            ts.cen = cell->lcInfo.cen;
+            ts.clk = cell->lcInfo.clk;
+            ts.sr = cell->lcInfo.sr;
+            ts.neg_clk = cell->lcInfo.negClk;
+            ts.ctrl_locals = control_set_locals(cell);
+        } else if (!same_control_set(ts, cell)) {
+            ts.conflict = true;
+        }
+        ts.dffs++;
+    }
+}
+
+void Arch::unbindLogicTile(BelId bel, const CellInfo *cell)
+{
+    LogicTileState &ts = getLogicTile(bel);
+    ts.lut_inputs -= cell->lcInfo.inputCount;
+    if (cell->lcInfo.dffEnable) {
+        ts.dffs--;
+        // The remaining DFFs may now agree, which can only be found by looking at them all again
+        if (ts.conflict)
+            rebuildLogicTile(bel);
+    }
+}
+
+void Arch::rebuildLogicTile(BelId bel)
+{
+    Loc bel_loc = getBelLocation(bel);
+    getLogicTile(bel) = LogicTileState();
+    for (auto bel_other : getBelsByTile(bel_loc.x, bel_loc.y)) {
+        CellInfo *ci_other = getBoundBelCell(bel_other);
+        if (ci_other != nullptr && ci_other->type == id_ICESTORM_LC)
+            bindLogicTile(bel_other, ci_other);
+    }
+}
+
 bool Arch::isBelLocationValid(BelId bel) const
 {
     if (getBelType(bel) == id_ICESTORM_LC) {
-        std::array<const CellInfo *, 8> bel_cells;
-        size_t num_cells = 0;
-        Loc bel_loc = getBelLocation(bel);
-        for (auto bel_other : getBelsByTile(bel_loc.x, bel_loc.y)) {
-            CellInfo *ci_other = getBoundBelCell(bel_other);
-            if (ci_other != nullptr)
-                bel_cells[num_cells++] = ci_other;
-        }
-        return logicCellsCompatible(bel_cells.data(), num_cells);
+        const LogicTileState &ts = getLogicTile(bel);
+        if (ts.conflict)
+            return false;
+        return (ts.dffs > 0 ? ts.ctrl_locals : 0) + ts.lut_inputs <= 32;
     } else {
         CellInfo *ci = getBoundBelCell(bel);
         if (ci == nullptr)
@@ -96,18 +150,42 @@ bool Arch::isValidBelForCell(CellInfo *cell, BelId bel) const
     if (cell->type == id_ICESTORM_LC) {
         NPNR_ASSERT(getBelType(bel) == id_ICESTORM_LC);
 
-        std::array<const CellInfo *, 8> bel_cells;
-        size_t num_cells = 0;
+        const LogicTileState &ts = getLogicTile(bel);
+        const CellInfo *bound = getBoundBelCell(bel);
+        if (bound == cell)
+            return isBelLocationValid(bel);
+
+        if (ts.conflict) {
+            // Replacing the bound cell might resolve the conflict, so check the tile cell by cell
+            std::array<const CellInfo *, 8> bel_cells;
+            size_t num_cells = 0;
+
+            Loc bel_loc = getBelLocation(bel);
+            for (auto bel_other : getBelsByTile(bel_loc.x, bel_loc.y)) {
+                CellInfo *ci_other = getBoundBelCell(bel_other);
+                if (ci_other != nullptr && bel_other != bel)
+                    bel_cells[num_cells++] = ci_other;
+            }
 
-        Loc bel_loc = getBelLocation(bel);
-        for (auto bel_other : getBelsByTile(bel_loc.x, bel_loc.y)) {
-            CellInfo *ci_other = getBoundBelCell(bel_other);
-            if (ci_other != nullptr && bel_other != bel)
-                bel_cells[num_cells++] = ci_other;
+            bel_cells[num_cells++] = cell;
+            return logicCellsCompatible(bel_cells.data(), num_cells);
         }
 
-        bel_cells[num_cells++] = cell;
-        return logicCellsCompatible(bel_cells.data(), num_cells);
+        int dffs = ts.dffs;
+        int locals_count = ts.lut_inputs + cell->lcInfo.inputCount;
+        if (bound != nullptr) {
+            locals_count -= bound->lcInfo.inputCount;
+            if (bound->lcInfo.dffEnable)
+                dffs--;
+        }
+        if (cell->lcInfo.dffEnable) {
+            if (dffs > 0 && !same_control_set(ts, cell))
+                return false;
+            locals_count += control_set_locals(cell);
+        } else if (dffs > 0) {
+            locals_count += ts.ctrl_locals;
+        }
+        return locals_count <= 32;
     } else if (cell->type == id_SB_IO) {
         // Do not allow placement of input SB_IOs on blocks where there a PLL is outputting to.
 
@@ -180,4 +258,18 @@ bool Arch::isValidBelForCell(CellInfo *cell, BelId bel) const
     }
 }
 
+bool Arch::isValidBelForCell(CellInfo *cell, BelId bel, CellInfo *replaced) const
+{
+    NPNR_ASSERT(getBoundBelCell(bel) == replaced);
+    if (cell->type == id_ICESTORM_LC && cell->bel != BelId()) {
+        Loc bel_loc = getBelLocation(bel), cell_loc = getBelLocation(cell->bel);
+        // Moving cells around within a logic tile leaves the cells in it, and
+        // so the tile state, the same
+        if (bel_loc.x == cell_loc.x && bel_loc.y == cell_loc.y)
+            return isBelLocationValid(bel);
+    }
+    // Between tiles, replaced leaving the Bel is what isValidBelForCell(cell, bel) already assumes
+    return isValidBelForCell(cell, bel);
+}
+
 NEXTPNR_NAMESPACE_END
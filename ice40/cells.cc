@@ -252,25 +252,25 @@ std::unique_ptr<CellInfo> create_ice_cell(Context *ctx, IdString type, std::stri
     return new_cell;
 }
 
-void lut_to_lc(const Context *ctx, CellInfo *lut, CellInfo *lc, bool no_dff)
+void lut_to_lc(const Context *ctx, CellInfo *lut, CellInfo *lc, bool no_dff, NetlistTransaction *tx)
 {
     lc->params[ctx->id("LUT_INIT")] = lut->params[ctx->id("LUT_INIT")];
-    replace_port(lut, ctx->id("I0"), lc, ctx->id("I0"));
-    replace_port(lut, ctx->id("I1"), lc, ctx->id("I1"));
-    replace_port(lut, ctx->id("I2"), lc, ctx->id("I2"));
-    replace_port(lut, ctx->id("I3"), lc, ctx->id("I3"));
+    replace_port(lut, ctx->id("I0"), lc, ctx->id("I0"), tx);
+    replace_port(lut, ctx->id("I1"), lc, ctx->id("I1"), tx);
+    replace_port(lut, ctx->id("I2"), lc, ctx->id("I2"), tx);
+    replace_port(lut, ctx->id("I3"), lc, ctx->id("I3"), tx);
     if (no_dff) {
-        replace_port(lut, ctx->id("O"), lc, ctx->id("O"));
+        replace_port(lut, ctx->id("O"), lc, ctx->id("O"), tx);
         lc->params[ctx->id("DFF_ENABLE")] = "0";
     }
 }
 
-void dff_to_lc(const Context *ctx, CellInfo *dff, CellInfo *lc, bool pass_thru_lut)
+void dff_to_lc(const Context *ctx, CellInfo *dff, CellInfo *lc, bool pass_thru_lut, NetlistTransaction *tx)
 {
     lc->params[ctx->id("DFF_ENABLE")] = "1";
     std::string config = dff->type.str(ctx).substr(6);
     auto citer = config.begin();
-    replace_port(dff, ctx->id("C"), lc, ctx->id("CLK"));
+    replace_port(dff, ctx->id("C"), lc, ctx->id("CLK"), tx);
 
     if (citer != config.end() && *citer == 'N') {
         lc->params[ctx->id("NEG_CLK")] = "1";
@@ -280,7 +280,7 @@ void dff_to_lc(const Context *ctx, CellInfo *dff, CellInfo *lc, bool pass_thru_l
     }
 
     if (citer != config.end() && *citer == 'E') {
-        replace_port(dff, ctx->id("E"), lc, ctx->id("CEN"));
+        replace_port(dff, ctx->id("E"), lc, ctx->id("CEN"), tx);
         ++citer;
     }
 
@@ -295,12 +295,12 @@ void dff_to_lc(const Context *ctx, CellInfo *dff, CellInfo *lc, bool pass_thru_l
 
         if (*citer == 'S') {
             citer++;
-            replace_port(dff, ctx->id("S"), lc, ctx->id("SR"));
+            replace_port(dff, ctx->id("S"), lc, ctx->id("SR"), tx);
             lc->params[ctx->id("SET_NORESET")] = "1";
         } else {
             NPNR_ASSERT(*citer == 'R');
             citer++;
-            replace_port(dff, ctx->id("R"), lc, ctx->id("SR"));
+            replace_port(dff, ctx->id("R"), lc, ctx->id("SR"), tx);
             lc->params[ctx->id("SET_NORESET")] = "0";
         }
     }
@@ -309,10 +309,10 @@ void dff_to_lc(const Context *ctx, CellInfo *dff, CellInfo *lc, bool pass_thru_l
 
     if (pass_thru_lut) {
         lc->params[ctx->id("LUT_INIT")] = "2";
-        replace_port(dff, ctx->id("D"), lc, ctx->id("I0"));
+        replace_port(dff, ctx->id("D"), lc, ctx->id("I0"), tx);
     }
 
-    replace_port(dff, ctx->id("Q"), lc, ctx->id("O"));
+    replace_port(dff, ctx->id("Q"), lc, ctx->id("O"), tx);
 }
 
 void nxio_to_sb(Context *ctx, CellInfo *nxio, CellInfo *sbio, std::unordered_set<IdString> &todelete_cells)
@@ -18,6 +18,7 @@
  *
  */
 
+#include "design_utils.h"
 #include "nextpnr.h"
 
 #ifndef ICE40_CELLS_H
@@ -89,13 +90,14 @@ uint8_t sb_pll40_type(const BaseCtx *ctx, const CellInfo *cell);
 // Convert a SB_LUT primitive to (part of) an ICESTORM_LC, swapping ports
 // as needed. Set no_dff if a DFF is not being used, so that the output
 // can be reconnected
-void lut_to_lc(const Context *ctx, CellInfo *lut, CellInfo *lc, bool no_dff = true);
+void lut_to_lc(const Context *ctx, CellInfo *lut, CellInfo *lc, bool no_dff = true, NetlistTransaction *tx = nullptr);
 
 // Convert a SB_DFFx primitive to (part of) an ICESTORM_LC, setting parameters
 // and reconnecting signals as necessary. If pass_thru_lut is True, the LUT will
 // be configured as pass through and D connected to I0, otherwise D will be
 // ignored
-void dff_to_lc(const Context *ctx, CellInfo *dff, CellInfo *lc, bool pass_thru_lut = false);
+void dff_to_lc(const Context *ctx, CellInfo *dff, CellInfo *lc, bool pass_thru_lut = false,
+               NetlistTransaction *tx = nullptr);
 
 // Convert a nextpnr IO buffer to a SB_IO
 void nxio_to_sb(Context *ctx, CellInfo *nxio, CellInfo *sbio, std::unordered_set<IdString> &todelete_cells);
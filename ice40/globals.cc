@@ -0,0 +1,139 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "globals.h"
+#include <queue>
+#include "log.h"
+#include "nextpnr.h"
+#include "util.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+class Ice40GlobalRouter
+{
+  public:
+    Ice40GlobalRouter(Context *ctx) : ctx(ctx){};
+
+  private:
+    int wire_type(WireId wire) const { return ctx->chip_info->wire_data[wire.index].type; }
+
+    // A net is routed on a global network if its source wire is one, as for
+    // SB_GB, or drives one through a dedicated pip, as for global inputs
+    bool drives_global_network(WireId src)
+    {
+        if (wire_type(src) == WireInfoPOD::WIRE_TYPE_GLB_NETWK)
+            return true;
+        for (auto pip : ctx->getPipsDownhill(src))
+            if (wire_type(ctx->getPipDstWire(pip)) == WireInfoPOD::WIRE_TYPE_GLB_NETWK)
+                return true;
+        return false;
+    }
+
+    // Wires the search back from a user may pass through: the global networks
+    // and the global to local muxes, but no local or general routing, which
+    // the general router may need for other nets
+    bool is_global_path_wire(WireId wire)
+    {
+        switch (wire_type(wire)) {
+        case WireInfoPOD::WIRE_TYPE_GLB_NETWK:
+        case WireInfoPOD::WIRE_TYPE_GLB2LOCAL:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Search back from the global pin of a logic tile user, such as a clock,
+    // until we reach the routing of the net, and bind the pips found. Returns
+    // false, binding nothing, if the user is not on a global pin or the
+    // routing of the net cannot be reached through free global path wires.
+    bool route_user(NetInfo *net, const PortRef &user)
+    {
+        WireId sink = ctx->getNetinfoSinkWire(net, user);
+        if (sink == WireId() || wire_type(sink) != WireInfoPOD::WIRE_TYPE_LUTFF_GLOBAL)
+            return false;
+        if (ctx->getBoundWireNet(sink) == net)
+            return true;
+
+        std::queue<WireId> upstream;
+        std::unordered_map<WireId, PipId> backtrace;
+        upstream.push(sink);
+        backtrace[sink] = PipId();
+        WireId cursor;
+        bool found = false;
+        while (!upstream.empty()) {
+            cursor = upstream.front();
+            upstream.pop();
+
+            if (ctx->getBoundWireNet(cursor) == net) {
+                found = true;
+                break;
+            }
+            if (!ctx->checkWireAvail(cursor) || (cursor != sink && !is_global_path_wire(cursor)))
+                continue;
+
+            for (auto pip : ctx->getPipsUphill(cursor)) {
+                WireId src = ctx->getPipSrcWire(pip);
+                if (backtrace.count(src) || !ctx->checkPipAvail(pip))
+                    continue;
+                backtrace[src] = pip;
+                upstream.push(src);
+            }
+        }
+        if (!found)
+            return false;
+
+        while (cursor != sink) {
+            PipId pip = backtrace.at(cursor);
+            ctx->bindPip(pip, net, STRENGTH_LOCKED);
+            cursor = ctx->getPipDstWire(pip);
+        }
+        return true;
+    }
+
+    Context *ctx;
+
+  public:
+    void route_globals()
+    {
+        log_info("Routing globals..\n");
+        for (auto net : sorted(ctx->nets)) {
+            NetInfo *ni = net.second;
+            if (ni->driver.cell == nullptr || ni->users.empty())
+                continue;
+            WireId src = ctx->getNetinfoSourceWire(ni);
+            if (src == WireId() || !drives_global_network(src))
+                continue;
+
+            NetInfo *bound = ctx->getBoundWireNet(src);
+            if (bound == nullptr)
+                ctx->bindWire(src, ni, STRENGTH_LOCKED);
+            else if (bound != ni)
+                continue;
+
+            int routed = 0;
+            for (auto &user : ni->users)
+                if (route_user(ni, user))
+                    routed++;
+            log_info("    routed %d/%d users of global net %s\n", routed, int(ni->users.size()), ni->name.c_str(ctx));
+        }
+    }
+};
+
+void route_ice40_globals(Context *ctx) { Ice40GlobalRouter(ctx).route_globals(); }
+
+NEXTPNR_NAMESPACE_END
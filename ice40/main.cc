@@ -66,6 +66,9 @@ po::options_description Ice40CommandHandler::getArchOptions()
     specific.add_options()("asc", po::value<std::string>(), "asc bitstream file to write");
     specific.add_options()("read", po::value<std::string>(), "asc bitstream file to read");
     specific.add_options()("tmfuzz", "run path delay estimate fuzzer");
+    specific.add_options()("no-route-globals",
+                           "leave global networks to the general router instead of routing them to logic cell global "
+                           "pins first");
     return specific;
 }
 void Ice40CommandHandler::validate()
@@ -99,6 +102,9 @@ void Ice40CommandHandler::setupArchContext(Context *ctx)
     if (vm.count("tmfuzz"))
         ice40DelayFuzzerMain(ctx);
 
+    if (vm.count("no-route-globals"))
+        settings->set("route/ice40Globals", false);
+
     if (vm.count("read")) {
         std::string filename = vm["read"].as<std::string>();
         std::ifstream f(filename);
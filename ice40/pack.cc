@@ -35,8 +35,7 @@ static void pack_lut_lutffs(Context *ctx)
 {
     log_info("Packing LUT-FFs..\n");
 
-    std::unordered_set<IdString> packed_cells;
-    std::vector<std::unique_ptr<CellInfo>> new_cells;
+    NetlistTransaction tx(ctx);
     for (auto cell : sorted(ctx->cells)) {
         CellInfo *ci = cell.second;
         if (ctx->verbose)
@@ -44,7 +43,7 @@ static void pack_lut_lutffs(Context *ctx)
         if (is_lut(ctx, ci)) {
             std::unique_ptr<CellInfo> packed = create_ice_cell(ctx, ctx->id("ICESTORM_LC"), ci->name.str(ctx) + "_LC");
             std::copy(ci->attrs.begin(), ci->attrs.end(), std::inserter(packed->attrs, packed->attrs.begin()));
-            packed_cells.insert(ci->name);
+            tx.remove_cell(ci->name);
             if (ctx->verbose)
                 log_info("packed cell %s into %s\n", ci->name.c_str(ctx), packed->name.c_str(ctx));
             // See if we can pack into a DFF
@@ -60,29 +59,24 @@ static void pack_lut_lutffs(Context *ctx)
                 if (lut_bel != ci->attrs.end() && dff_bel != dff->attrs.end() && lut_bel->second != dff_bel->second) {
                     // Locations don't match, can't pack
                 } else {
-                    lut_to_lc(ctx, ci, packed.get(), false);
-                    dff_to_lc(ctx, dff, packed.get(), false);
+                    lut_to_lc(ctx, ci, packed.get(), false, &tx);
+                    dff_to_lc(ctx, dff, packed.get(), false, &tx);
                     ctx->nets.erase(o->name);
                     if (dff_bel != dff->attrs.end())
                         packed->attrs[ctx->id("BEL")] = dff_bel->second;
-                    packed_cells.insert(dff->name);
+                    tx.remove_cell(dff->name);
                     if (ctx->verbose)
                         log_info("packed cell %s into %s\n", dff->name.c_str(ctx), packed->name.c_str(ctx));
                     packed_dff = true;
                 }
             }
             if (!packed_dff) {
-                lut_to_lc(ctx, ci, packed.get(), true);
+                lut_to_lc(ctx, ci, packed.get(), true, &tx);
             }
-            new_cells.push_back(std::move(packed));
+            tx.add_cell(std::move(packed));
         }
     }
-    for (auto pcell : packed_cells) {
-        ctx->cells.erase(pcell);
-    }
-    for (auto &ncell : new_cells) {
-        ctx->cells[ncell->name] = std::move(ncell);
-    }
+    tx.commit();
 }
 
 // Pack FFs not packed as LUTFFs
@@ -90,8 +84,7 @@ static void pack_nonlut_ffs(Context *ctx)
 {
     log_info("Packing non-LUT FFs..\n");
 
-    std::unordered_set<IdString> packed_cells;
-    std::vector<std::unique_ptr<CellInfo>> new_cells;
+    NetlistTransaction tx(ctx);
 
     for (auto cell : sorted(ctx->cells)) {
         CellInfo *ci = cell.second;
@@ -101,17 +94,12 @@ static void pack_nonlut_ffs(Context *ctx)
             std::copy(ci->attrs.begin(), ci->attrs.end(), std::inserter(packed->attrs, packed->attrs.begin()));
             if (ctx->verbose)
                 log_info("packed cell %s into %s\n", ci->name.c_str(ctx), packed->name.c_str(ctx));
-            packed_cells.insert(ci->name);
-            dff_to_lc(ctx, ci, packed.get(), true);
-            new_cells.push_back(std::move(packed));
+            tx.remove_cell(ci->name);
+            dff_to_lc(ctx, ci, packed.get(), true, &tx);
+            tx.add_cell(std::move(packed));
         }
     }
-    for (auto pcell : packed_cells) {
-        ctx->cells.erase(pcell);
-    }
-    for (auto &ncell : new_cells) {
-        ctx->cells[ncell->name] = std::move(ncell);
-    }
+    tx.commit();
 }
 
 static bool net_is_constant(const Context *ctx, NetInfo *net, bool &value)
@@ -0,0 +1,288 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+// Micro-benchmarks of the Arch API calls the placer and router spend most of
+// their time in, on a real device database where the family has one.
+
+#include <algorithm>
+#include <vector>
+#include "log.h"
+#include "microbench.h"
+#include "nextpnr.h"
+
+USING_NEXTPNR_NAMESPACE
+
+volatile int64_t microbench_sink = 0;
+
+namespace {
+
+// Upper bound on the objects of each kind each benchmark runs over.
+const size_t max_samples = 4096;
+
+// Routes searched by the getActualRouteDelay benchmark, and the number of
+// pips between their ends.
+const size_t max_routes = 256;
+const int route_length = 8;
+
+Context *create_context()
+{
+    ArchArgs chipArgs;
+#if defined(ARCH_ICE40)
+#ifdef ICE40_HX1K_ONLY
+    chipArgs.type = ArchArgs::HX1K;
+    chipArgs.package = "tq144";
+#else
+    chipArgs.type = ArchArgs::HX8K;
+    chipArgs.package = "ct256";
+#endif
+    return new Context(chipArgs);
+#elif defined(ARCH_ECP5)
+    chipArgs.type = ArchArgs::LFE5U_45F;
+    chipArgs.package = "CABGA381";
+    return new Context(chipArgs);
+#else
+    // There is no device database for generic, so build a synthetic grid of
+    // tiles each with a few logic bels, connected to their neighbours.
+    Context *ctx = new Context(chipArgs);
+    const int size = 32, wires_per_tile = 8, bels_per_tile = 4;
+    auto wire_name = [ctx](int x, int y, int i) { return ctx->id(stringf("X%dY%d/W%d", x, y, i)); };
+    for (int x = 0; x < size; x++)
+        for (int y = 0; y < size; y++)
+            for (int i = 0; i < wires_per_tile; i++)
+                ctx->addWire(wire_name(x, y, i), ctx->id("WIRE"), x, y);
+    for (int x = 0; x < size; x++) {
+        for (int y = 0; y < size; y++) {
+            for (int i = 0; i < wires_per_tile; i++) {
+                const int dx[] = {1, -1, 0, 0}, dy[] = {0, 0, 1, -1};
+                for (int d = 0; d < 4; d++) {
+                    int nx = x + dx[d], ny = y + dy[d];
+                    if (nx < 0 || nx >= size || ny < 0 || ny >= size)
+                        continue;
+                    ctx->addPip(ctx->id(stringf("X%dY%d/P%d_%d", x, y, i, d)), ctx->id("PIP"), wire_name(x, y, i),
+                                wire_name(nx, ny, (i + d) % wires_per_tile), DelayInfo(), Loc(x, y, 0));
+                }
+            }
+            for (int z = 0; z < bels_per_tile; z++) {
+                IdString bel = ctx->id(stringf("X%dY%d/LUT%d", x, y, z));
+                ctx->addBel(bel, ctx->id("LUT"), Loc(x, y, z), false);
+                ctx->addBelInput(bel, ctx->id("I"), wire_name(x, y, 2 * z));
+                ctx->addBelOutput(bel, ctx->id("O"), wire_name(x, y, 2 * z + 1));
+            }
+        }
+    }
+    return ctx;
+#endif
+}
+
+// The type of the logic cell bels, used to benchmark isValidBelForCell.
+IdString logic_cell_type(Context *ctx)
+{
+#if defined(ARCH_ICE40)
+    return ctx->id("ICESTORM_LC");
+#elif defined(ARCH_ECP5)
+    return ctx->id("TRELLIS_SLICE");
+#else
+    return ctx->id("LUT");
+#endif
+}
+
+// Pick up to max_samples items spread evenly over a range.
+template <typename T, typename Range> std::vector<T> sample(const Range &range)
+{
+    std::vector<T> all;
+    for (auto item : range)
+        all.push_back(item);
+    std::vector<T> result;
+    size_t stride = std::max<size_t>(1, all.size() / max_samples);
+    for (size_t i = 0; i < all.size() && result.size() < max_samples; i += stride)
+        result.push_back(all.at(i));
+    return result;
+}
+
+} // namespace
+
+class ArchCallsBench : public ::testing::Test
+{
+  protected:
+    static void SetUpTestCase()
+    {
+        ctx = create_context();
+        bels = sample<BelId>(ctx->getBels());
+        wires = sample<WireId>(ctx->getWires());
+        pips = sample<PipId>(ctx->getPips());
+        for (auto bel : bels)
+            bel_names.push_back(ctx->getBelName(bel));
+
+        // Follow a few pips downhill from each wire, so that the router has
+        // a short route to find between them
+        for (size_t i = 0; i < wires.size() && routes.size() < max_routes; i++) {
+            WireId cursor = wires.at(i);
+            for (int j = 0; j < route_length; j++) {
+                std::vector<PipId> downhill;
+                for (auto pip : ctx->getPipsDownhill(cursor))
+                    downhill.push_back(pip);
+                if (downhill.empty())
+                    break;
+                cursor = ctx->getPipDstWire(downhill.at((i + j * 7) % downhill.size()));
+            }
+            if (cursor != wires.at(i))
+                routes.push_back(std::make_pair(wires.at(i), cursor));
+        }
+
+        IdString lc_type = logic_cell_type(ctx);
+        std::vector<BelId> lc_bels;
+        for (auto bel : ctx->getBels())
+            if (ctx->getBelType(bel) == lc_type)
+                lc_bels.push_back(bel);
+        logic_bels = sample<BelId>(lc_bels);
+
+        std::unique_ptr<CellInfo> cell(new CellInfo());
+        cell->name = ctx->id("$bench$cell");
+        cell->type = lc_type;
+        logic_cell = cell.get();
+        ctx->cells[cell->name] = std::move(cell);
+#ifndef ARCH_GENERIC
+        ctx->assignArchInfo();
+#endif
+    }
+
+    static void TearDownTestCase()
+    {
+        delete ctx;
+        ctx = nullptr;
+        bels.clear();
+        wires.clear();
+        pips.clear();
+        bel_names.clear();
+        logic_bels.clear();
+        routes.clear();
+    }
+
+    static Context *ctx;
+    static std::vector<BelId> bels, logic_bels;
+    static std::vector<WireId> wires;
+    static std::vector<PipId> pips;
+    static std::vector<IdString> bel_names;
+    static std::vector<std::pair<WireId, WireId>> routes;
+    static CellInfo *logic_cell;
+};
+
+Context *ArchCallsBench::ctx = nullptr;
+std::vector<BelId> ArchCallsBench::bels, ArchCallsBench::logic_bels;
+std::vector<WireId> ArchCallsBench::wires;
+std::vector<PipId> ArchCallsBench::pips;
+std::vector<IdString> ArchCallsBench::bel_names;
+std::vector<std::pair<WireId, WireId>> ArchCallsBench::routes;
+CellInfo *ArchCallsBench::logic_cell = nullptr;
+
+TEST_F(ArchCallsBench, getPipsDownhill)
+{
+    ASSERT_FALSE(wires.empty());
+    run_microbench(wires.size(), [&]() {
+        int64_t count = 0;
+        for (auto wire : wires)
+            for (auto pip : ctx->getPipsDownhill(wire)) {
+                (void)pip;
+                count++;
+            }
+        return count;
+    });
+}
+
+TEST_F(ArchCallsBench, checkWireAvail)
+{
+    ASSERT_FALSE(wires.empty());
+    run_microbench(wires.size(), [&]() {
+        int64_t count = 0;
+        for (auto wire : wires)
+            count += ctx->checkWireAvail(wire);
+        return count;
+    });
+}
+
+TEST_F(ArchCallsBench, checkPipAvail)
+{
+    ASSERT_FALSE(pips.empty());
+    run_microbench(pips.size(), [&]() {
+        int64_t count = 0;
+        for (auto pip : pips)
+            count += ctx->checkPipAvail(pip);
+        return count;
+    });
+}
+
+TEST_F(ArchCallsBench, estimateDelay)
+{
+    ASSERT_FALSE(wires.empty());
+    run_microbench(wires.size(), [&]() {
+        int64_t total = 0;
+        // Pair each wire with one far away in the sample, so the pairs cover
+        // a spread of distances.
+        for (size_t i = 0; i < wires.size(); i++)
+            total += ctx->estimateDelay(wires.at(i), wires.at((i * 7 + wires.size() / 2) % wires.size()));
+        return total;
+    });
+}
+
+TEST_F(ArchCallsBench, getBelLocation)
+{
+    ASSERT_FALSE(bels.empty());
+    run_microbench(bels.size(), [&]() {
+        int64_t total = 0;
+        for (auto bel : bels) {
+            Loc loc = ctx->getBelLocation(bel);
+            total += loc.x + loc.y + loc.z;
+        }
+        return total;
+    });
+}
+
+TEST_F(ArchCallsBench, isValidBelForCell)
+{
+    ASSERT_FALSE(logic_bels.empty());
+    run_microbench(logic_bels.size(), [&]() {
+        int64_t count = 0;
+        for (auto bel : logic_bels)
+            count += ctx->isValidBelForCell(logic_cell, bel);
+        return count;
+    });
+}
+
+TEST_F(ArchCallsBench, getBelByName)
+{
+    ASSERT_FALSE(bel_names.empty());
+    run_microbench(bel_names.size(), [&]() {
+        int64_t count = 0;
+        for (auto name : bel_names)
+            count += (ctx->getBelByName(name) != BelId());
+        return count;
+    });
+}
+
+TEST_F(ArchCallsBench, getActualRouteDelay)
+{
+    ASSERT_FALSE(routes.empty());
+    run_microbench(routes.size(), [&]() {
+        int64_t total = 0;
+        for (auto &route : routes) {
+            delay_t delay = 0;
+            if (ctx->getActualRouteDelay(route.first, route.second, &delay))
+                total += int64_t(delay);
+        }
+        return total;
+    });
+}
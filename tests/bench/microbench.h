@@ -0,0 +1,61 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include "gtest/gtest.h"
+
+// Minimal micro-benchmark support on top of googletest. Each benchmark is a
+// test that times a batch of calls, and reports the mean time per call on
+// stdout and as the "ns_per_call" test property, so that running with
+// --gtest_output=xml:FILE gives machine-readable results.
+
+// Results of benchmarked calls are added here, so that they cannot be
+// optimised away.
+extern volatile int64_t microbench_sink;
+
+// Run batch, which makes the given number of calls and returns a value
+// depending on all their results, until at least min_seconds have passed.
+// Returns the mean time per call in nanoseconds.
+template <typename F> double run_microbench(size_t calls, F batch, double min_seconds = 0.2)
+{
+    typedef std::chrono::steady_clock clock;
+
+    // Warm up caches.
+    microbench_sink += batch();
+
+    size_t reps = 0;
+    double elapsed = 0;
+    auto start = clock::now();
+    do {
+        microbench_sink += batch();
+        reps++;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < min_seconds);
+
+    double ns = (elapsed * 1e9) / (double(reps) * double(calls));
+    printf("%-32s %12.2f ns/call\n", ::testing::UnitTest::GetInstance()->current_test_info()->name(), ns);
+    ::testing::Test::RecordProperty("ns_per_call", std::to_string(ns));
+    return ns;
+}
+
+#endif
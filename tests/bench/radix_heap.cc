@@ -0,0 +1,101 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+// Micro-benchmarks of the router's priority queue, comparing RadixHeap with
+// the std::priority_queue it replaced, on the push and pop pattern of a
+// search: each popped entry pushes a few more with slightly larger keys.
+
+#include <queue>
+#include <vector>
+#include "microbench.h"
+#include "nextpnr.h"
+#include "radix_heap.h"
+
+USING_NEXTPNR_NAMESPACE
+
+namespace {
+
+// Entries popped per batch.
+const size_t pops_per_batch = 100000;
+
+// Same size as the router's queue entries.
+struct Entry
+{
+    WireId wire;
+    PipId pip;
+    delay_t delay, togo;
+};
+
+// Key increments of the entries pushed for each one popped, spread like
+// pip delays.
+std::vector<uint64_t> make_steps()
+{
+    auto rng = NEXTPNR_NAMESPACE::DeterministicRNG();
+    std::vector<uint64_t> steps;
+    for (size_t i = 0; i < 4 * pops_per_batch; i++)
+        steps.push_back(rng.rng(500));
+    return steps;
+}
+
+struct Greater
+{
+    bool operator()(const std::pair<uint64_t, Entry> &lhs, const std::pair<uint64_t, Entry> &rhs) const
+    {
+        return lhs.first > rhs.first;
+    }
+};
+
+} // namespace
+
+TEST(PriorityQueueBench, std_priority_queue)
+{
+    std::vector<uint64_t> steps = make_steps();
+    run_microbench(pops_per_batch, [&]() {
+        std::priority_queue<std::pair<uint64_t, Entry>, std::vector<std::pair<uint64_t, Entry>>, Greater> queue;
+        size_t step = 0;
+        int64_t total = 0;
+        queue.push(std::make_pair(uint64_t(0), Entry()));
+        for (size_t i = 0; i < pops_per_batch && !queue.empty(); i++) {
+            uint64_t key = queue.top().first;
+            queue.pop();
+            total += key;
+            // Two or three children per entry keeps the queue growing.
+            for (int j = 0; j < 2 + int(i % 2); j++)
+                queue.push(std::make_pair(key + steps.at(step++ % steps.size()), Entry()));
+        }
+        return total;
+    });
+}
+
+TEST(PriorityQueueBench, radix_heap)
+{
+    std::vector<uint64_t> steps = make_steps();
+    run_microbench(pops_per_batch, [&]() {
+        RadixHeap<Entry> queue;
+        size_t step = 0;
+        int64_t total = 0;
+        queue.push(0, Entry());
+        for (size_t i = 0; i < pops_per_batch && !queue.empty(); i++) {
+            uint64_t key = queue.top_key();
+            queue.pop();
+            total += key;
+            for (int j = 0; j < 2 + int(i % 2); j++)
+                queue.push(key + steps.at(step++ % steps.size()), Entry());
+        }
+        return total;
+    });
+}
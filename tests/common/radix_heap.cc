@@ -0,0 +1,99 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <vector>
+#include "gtest/gtest.h"
+#include "nextpnr.h"
+#include "radix_heap.h"
+
+USING_NEXTPNR_NAMESPACE
+
+// Test that values come out in key order when all are pushed first.
+TEST(RadixHeapTest, sorts)
+{
+    auto rng = NEXTPNR_NAMESPACE::DeterministicRNG();
+    RadixHeap<int> heap;
+    std::vector<uint64_t> keys;
+    for (int i = 0; i < 10000; i++) {
+        uint64_t key = rng.rng64() >> rng.rng(64);
+        keys.push_back(key);
+        heap.push(key, i);
+    }
+    ASSERT_EQ(heap.size(), keys.size());
+    std::vector<uint64_t> sorted = keys;
+    std::sort(sorted.begin(), sorted.end());
+    for (auto expected : sorted) {
+        ASSERT_EQ(heap.top_key(), expected);
+        ASSERT_EQ(keys.at(heap.pop()), expected);
+    }
+    ASSERT_TRUE(heap.empty());
+}
+
+// Test pushes between pops, as a search makes them, against a sorted list.
+TEST(RadixHeapTest, interleaved)
+{
+    auto rng = NEXTPNR_NAMESPACE::DeterministicRNG();
+    RadixHeap<uint64_t> heap;
+    std::vector<uint64_t> pending;
+    heap.push(0, 0);
+    pending.push_back(0);
+    for (int i = 0; i < 20000 && !heap.empty(); i++) {
+        std::sort(pending.begin(), pending.end());
+        uint64_t key = heap.top_key();
+        ASSERT_EQ(key, pending.front());
+        ASSERT_EQ(heap.pop(), key);
+        pending.erase(pending.begin());
+        int children = rng.rng(3);
+        for (int j = 0; j < children; j++) {
+            uint64_t child = key + rng.rng(1000);
+            heap.push(child, child);
+            pending.push_back(child);
+        }
+    }
+    ASSERT_EQ(heap.size(), pending.size());
+}
+
+// Test that keys below the last one popped are raised to it.
+TEST(RadixHeapTest, raises_small_keys)
+{
+    RadixHeap<int> heap;
+    heap.push(10, 1);
+    heap.push(20, 2);
+    ASSERT_EQ(heap.pop(), 1);
+    heap.push(5, 3);
+    ASSERT_EQ(heap.top_key(), uint64_t(10));
+    ASSERT_EQ(heap.pop(), 3);
+    ASSERT_EQ(heap.pop(), 2);
+    ASSERT_TRUE(heap.empty());
+}
+
+// Test that clearing allows smaller keys again.
+TEST(RadixHeapTest, clear)
+{
+    RadixHeap<int> heap;
+    heap.push(100, 1);
+    heap.push(200, 2);
+    ASSERT_EQ(heap.pop(), 1);
+    heap.clear();
+    ASSERT_TRUE(heap.empty());
+    heap.push(3, 3);
+    heap.push(1, 4);
+    ASSERT_EQ(heap.top_key(), uint64_t(1));
+    ASSERT_EQ(heap.pop(), 4);
+    ASSERT_EQ(heap.pop(), 3);
+}
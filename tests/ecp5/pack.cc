@@ -0,0 +1,143 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <string>
+#include <vector>
+#include "cells.h"
+#include "design_utils.h"
+#include "gtest/gtest.h"
+#include "log.h"
+#include "nextpnr.h"
+#include "settings.h"
+#include "util.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class PackTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        log_streams.clear();
+        chipArgs.type = ArchArgs::LFE5U_25F;
+        chipArgs.package = "CABGA381";
+        ctx = new Context(chipArgs);
+        ctx->rngseed(1);
+
+        // LUTs, most with an FF on their output, wired to each other at
+        // random, and FFs with control sets drawn from few enough choices
+        // that some pairs can share a slice and some can not
+        std::vector<NetInfo *> nets, ctrl;
+        for (int i = 0; i < 3; i++) {
+            std::string idx = std::to_string(i);
+            CellInfo *lut = add_cell(create_ecp5_cell(ctx, id_LUT4, "ctrl_lut" + idx));
+            ctrl.push_back(add_net("ctrl" + idx));
+            connect_port(ctx, ctrl.back(), lut, id_Z);
+        }
+
+        const int n = 600;
+        for (int i = 0; i < n; i++) {
+            std::string idx = std::to_string(i);
+            CellInfo *lut = add_cell(create_ecp5_cell(ctx, id_LUT4, "lut" + idx));
+            lut->params[ctx->id("INIT")] = std::to_string(ctx->rng(65536));
+            nets.push_back(add_net("z" + idx));
+            connect_port(ctx, nets.back(), lut, id_Z);
+            if (ctx->rng(3) == 0)
+                continue;
+
+            CellInfo *ff = add_cell(create_ff("ff" + idx));
+            connect_port(ctx, nets.back(), ff, id_DI);
+            nets.push_back(add_net("q" + idx));
+            connect_port(ctx, nets.back(), ff, id_Q);
+            connect_port(ctx, ctrl.at(ctx->rng(2)), ff, id_CLK);
+            if (ctx->rng(2) == 0)
+                connect_port(ctx, ctrl.at(2), ff, id_LSR);
+            ff->params[id_CLKMUX] = ctx->rng(4) == 0 ? "INV" : "CLK";
+            ff->params[id_SRMODE] = ctx->rng(4) == 0 ? "ASYNC" : "LSR_OVER_CE";
+        }
+
+        for (auto &cell : ctx->cells) {
+            if (cell.second->type != id_LUT4)
+                continue;
+            for (IdString port : {id_A, id_B, id_C, id_D})
+                if (ctx->rng(4) != 0)
+                    connect_port(ctx, nets.at(ctx->rng(int(nets.size()))), cell.second.get(), port);
+        }
+    }
+
+    virtual void TearDown() { delete ctx; }
+
+    std::unique_ptr<CellInfo> create_ff(const std::string &name)
+    {
+        std::unique_ptr<CellInfo> ff(new CellInfo());
+        ff->name = ctx->id(name);
+        ff->type = id_TRELLIS_FF;
+        for (IdString port : {id_CLK, id_LSR, id_CE, id_DI, ctx->id("M")})
+            ff->ports[port] = PortInfo{port, nullptr, PORT_IN};
+        ff->ports[id_Q] = PortInfo{id_Q, nullptr, PORT_OUT};
+        return ff;
+    }
+
+    CellInfo *add_cell(std::unique_ptr<CellInfo> cell)
+    {
+        CellInfo *ptr = cell.get();
+        ctx->cells[cell->name] = std::move(cell);
+        return ptr;
+    }
+
+    NetInfo *add_net(const std::string &name)
+    {
+        std::unique_ptr<NetInfo> net(new NetInfo());
+        net->name = ctx->id(name);
+        NetInfo *ptr = net.get();
+        ctx->nets[net->name] = std::move(net);
+        return ptr;
+    }
+
+    ArchArgs chipArgs;
+    Context *ctx;
+};
+
+TEST_F(PackTest, parallel_matches_sequential)
+{
+    // Pack one copy of the design with every search split into the smallest
+    // chunks and one with every search on a single thread
+    std::unique_ptr<Context> seq = ctx->clone();
+    Settings(ctx).set("pack/parallelChunk", 1);
+    Settings(seq.get()).set("pack/parallelChunk", 1 << 30);
+    ASSERT_TRUE(ctx->pack());
+    ASSERT_TRUE(seq->pack());
+
+    ASSERT_EQ(ctx->cells.size(), seq->cells.size());
+    for (auto cell : sorted(ctx->cells)) {
+        CellInfo *ci = cell.second;
+        auto fnd = seq->cells.find(seq->id(ci->name.str(ctx)));
+        ASSERT_TRUE(fnd != seq->cells.end()) << ci->name.str(ctx);
+        CellInfo *seq_ci = fnd->second.get();
+        EXPECT_EQ(ci->type.str(ctx), seq_ci->type.str(seq.get())) << ci->name.str(ctx);
+        ASSERT_EQ(ci->ports.size(), seq_ci->ports.size()) << ci->name.str(ctx);
+        for (auto &port : ci->ports) {
+            const NetInfo *seq_net = seq_ci->ports.at(seq->id(port.first.str(ctx))).net;
+            EXPECT_EQ(port.second.net == nullptr ? "" : port.second.net->name.str(ctx),
+                      seq_net == nullptr ? "" : seq_net->name.str(seq.get()))
+                    << ci->name.str(ctx) << "." << port.first.str(ctx);
+        }
+        for (auto &param : ci->params)
+            EXPECT_EQ(param.second, str_or_default(seq_ci->params, seq->id(param.first.str(ctx))))
+                    << ci->name.str(ctx) << " " << param.first.str(ctx);
+    }
+}
@@ -0,0 +1,145 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <map>
+#include <vector>
+#include "gtest/gtest.h"
+#include "nextpnr.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class SliceTileTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        chipArgs.type = ArchArgs::LFE5U_25F;
+        chipArgs.package = "CABGA381";
+        ctx = new Context(chipArgs);
+        ctx->rngseed(1);
+
+        // Slices with random control sets, drawn from few enough choices that
+        // tiles both share and conflict
+        for (int i = 0; i < 24; i++) {
+            std::unique_ptr<CellInfo> cell(new CellInfo());
+            cell->name = ctx->id("slice" + std::to_string(i));
+            cell->type = ctx->id("TRELLIS_SLICE");
+            cell->sliceInfo.using_dff = ctx->rng(3) != 0;
+            cell->sliceInfo.clk_sig = random_id({"", "clk0", "clk1"});
+            cell->sliceInfo.lsr_sig = random_id({"", "lsr0"});
+            cell->sliceInfo.clkmux = random_id({"CLK", "INV"});
+            cell->sliceInfo.lsrmux = random_id({"LSR", "INV"});
+            cell->sliceInfo.srmode = random_id({"LSR_OVER_CE", "ASYNC"});
+            cells.push_back(cell.get());
+            ctx->cells[cell->name] = std::move(cell);
+        }
+
+        for (auto bel : ctx->getBels()) {
+            if (ctx->getBelType(bel) != ctx->id("TRELLIS_SLICE"))
+                continue;
+            Loc loc = ctx->getBelLocation(bel);
+            auto key = std::make_pair(loc.x, loc.y);
+            if (!tiles.count(key) && tiles.size() == 4)
+                continue;
+            tiles[key].push_back(bel);
+        }
+    }
+
+    virtual void TearDown() { delete ctx; }
+
+    IdString random_id(const std::vector<std::string> &choices)
+    {
+        return ctx->id(choices.at(ctx->rng(int(choices.size()))));
+    }
+
+    // The reference answer: every slice in the tile, with cell in place of
+    // whatever is bound to bel if cell is not null
+    bool compatible(const std::vector<BelId> &tile, BelId bel, const CellInfo *cell)
+    {
+        std::vector<const CellInfo *> tile_cells;
+        for (auto bel_other : tile) {
+            const CellInfo *ci = ctx->getBoundBelCell(bel_other);
+            if (cell != nullptr && bel_other == bel)
+                ci = cell;
+            if (ci != nullptr)
+                tile_cells.push_back(ci);
+        }
+        return ctx->slicesCompatible(tile_cells.data(), tile_cells.size());
+    }
+
+    // The reference answer for a swap: every slice in the tile, with the
+    // bound slice cell and the slice bound to bel, if any, trading places
+    bool swap_compatible(const std::vector<BelId> &tile, BelId bel, const CellInfo *cell)
+    {
+        std::vector<const CellInfo *> tile_cells;
+        for (auto bel_other : tile) {
+            const CellInfo *ci = ctx->getBoundBelCell(bel_other);
+            if (bel_other == bel)
+                ci = cell;
+            else if (bel_other == cell->bel)
+                ci = ctx->getBoundBelCell(bel);
+            if (ci != nullptr)
+                tile_cells.push_back(ci);
+        }
+        return ctx->slicesCompatible(tile_cells.data(), tile_cells.size());
+    }
+
+    ArchArgs chipArgs;
+    Context *ctx;
+    std::vector<CellInfo *> cells;
+    std::map<std::pair<int, int>, std::vector<BelId>> tiles;
+};
+
+TEST_F(SliceTileTest, random_bind_unbind)
+{
+    ASSERT_EQ(tiles.size(), size_t(4));
+    std::vector<BelId> bels;
+    for (auto &tile : tiles)
+        bels.insert(bels.end(), tile.second.begin(), tile.second.end());
+
+    for (int step = 0; step < 2000; step++) {
+        BelId bel = bels.at(ctx->rng(int(bels.size())));
+        if (ctx->getBoundBelCell(bel) != nullptr) {
+            ctx->unbindBel(bel);
+        } else {
+            CellInfo *cell = cells.at(ctx->rng(int(cells.size())));
+            if (cell->bel != BelId())
+                ctx->unbindBel(cell->bel);
+            ctx->bindBel(bel, cell, STRENGTH_WEAK);
+        }
+
+        for (auto &tile : tiles) {
+            for (auto tile_bel : tile.second) {
+                ASSERT_EQ(ctx->isBelLocationValid(tile_bel), compatible(tile.second, tile_bel, nullptr))
+                        << "step " << step;
+                for (auto cell : cells) {
+                    if (cell->bel != BelId() && cell->bel != tile_bel)
+                        continue;
+                    ASSERT_EQ(ctx->isValidBelForCell(cell, tile_bel), compatible(tile.second, tile_bel, cell))
+                            << "step " << step << " cell " << cell->name.str(ctx);
+                }
+                for (auto cell : cells) {
+                    if (cell->bel == BelId() || cell->bel == tile_bel)
+                        continue;
+                    ASSERT_EQ(ctx->isValidBelForCell(cell, tile_bel, ctx->getBoundBelCell(tile_bel)),
+                              swap_compatible(tile.second, tile_bel, cell))
+                            << "step " << step << " swap " << cell->name.str(ctx);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,150 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <string>
+#include "design_utils.h"
+#include "gtest/gtest.h"
+#include "nextpnr.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class NetlistTransactionTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ctx = new Context(chipArgs);
+        // A driver of net n and loads a, b and c, each with inputs I and J
+        drv = add_cell("drv");
+        for (auto name : {"a", "b", "c"})
+            add_cell(name);
+        std::unique_ptr<NetInfo> net(new NetInfo());
+        net->name = ctx->id("n");
+        n = net.get();
+        ctx->nets[net->name] = std::move(net);
+        connect_port(ctx, n, drv, ctx->id("O"));
+    }
+
+    virtual void TearDown() { delete ctx; }
+
+    CellInfo *add_cell(const std::string &name)
+    {
+        std::unique_ptr<CellInfo> cell = create_cell(name);
+        CellInfo *ptr = cell.get();
+        ctx->cells[ptr->name] = std::move(cell);
+        return ptr;
+    }
+
+    std::unique_ptr<CellInfo> create_cell(const std::string &name)
+    {
+        std::unique_ptr<CellInfo> cell(new CellInfo());
+        cell->name = ctx->id(name);
+        cell->type = ctx->id("CELL");
+        for (auto port : {"I", "J"})
+            cell->ports[ctx->id(port)] = PortInfo{ctx->id(port), nullptr, PORT_IN};
+        cell->ports[ctx->id("O")] = PortInfo{ctx->id("O"), nullptr, PORT_OUT};
+        return cell;
+    }
+
+    CellInfo *cell(const char *name) { return ctx->cells.at(ctx->id(name)).get(); }
+
+    // The users of net n, as cell.port strings
+    std::vector<std::string> users()
+    {
+        std::vector<std::string> names;
+        for (auto &user : n->users)
+            names.push_back(user.cell->name.str(ctx) + "." + user.port.str(ctx));
+        return names;
+    }
+
+    ArchArgs chipArgs;
+    Context *ctx;
+    CellInfo *drv;
+    NetInfo *n;
+};
+
+TEST_F(NetlistTransactionTest, moves_follow_chains_on_commit)
+{
+    connect_port(ctx, n, cell("a"), ctx->id("I"));
+    connect_port(ctx, n, cell("b"), ctx->id("J"));
+
+    NetlistTransaction tx(ctx);
+    EXPECT_TRUE(tx.empty());
+    // a.I -> b.I -> c.J within one transaction, and b.J disconnected
+    replace_port(cell("a"), ctx->id("I"), cell("b"), ctx->id("I"), &tx);
+    replace_port(cell("b"), ctx->id("I"), cell("c"), ctx->id("J"), &tx);
+    disconnect_port(ctx, cell("b"), ctx->id("J"), &tx);
+    EXPECT_FALSE(tx.empty());
+
+    // The user list is untouched until the commit, the ports are not
+    EXPECT_EQ(users(), std::vector<std::string>({"a.I", "b.J"}));
+    EXPECT_EQ(cell("c")->ports.at(ctx->id("J")).net, n);
+    EXPECT_EQ(cell("a")->ports.at(ctx->id("I")).net, nullptr);
+
+    tx.commit();
+    EXPECT_TRUE(tx.empty());
+    EXPECT_EQ(users(), std::vector<std::string>({"c.J"}));
+}
+
+TEST_F(NetlistTransactionTest, added_users_are_moved)
+{
+    NetlistTransaction tx(ctx);
+    connect_port(ctx, n, cell("a"), ctx->id("J"), &tx);
+    EXPECT_TRUE(n->users.empty());
+    // A user added earlier in the transaction follows later moves
+    replace_port(cell("a"), ctx->id("J"), cell("b"), ctx->id("I"), &tx);
+    connect_port(ctx, n, cell("c"), ctx->id("I"), &tx);
+
+    tx.commit();
+    EXPECT_EQ(users(), std::vector<std::string>({"b.I", "c.I"}));
+}
+
+TEST_F(NetlistTransactionTest, cells_erased_and_added_on_commit)
+{
+    connect_port(ctx, n, cell("a"), ctx->id("I"));
+
+    NetlistTransaction tx(ctx);
+    CellInfo *a = cell("a");
+    CellInfo *d = tx.add_cell(create_cell("d"));
+    replace_port(a, ctx->id("I"), d, ctx->id("I"), &tx);
+    tx.remove_cell(a->name);
+    tx.remove_cell(ctx->id("b"));
+    EXPECT_TRUE(tx.is_removed(ctx->id("a")));
+
+    // Removed cells stay valid and new cells stay out of the design until the commit
+    EXPECT_EQ(ctx->cells.count(ctx->id("a")), size_t(1));
+    EXPECT_EQ(ctx->cells.count(ctx->id("d")), size_t(0));
+    EXPECT_EQ(a->name, ctx->id("a"));
+
+    tx.commit();
+    EXPECT_EQ(ctx->cells.count(ctx->id("a")), size_t(0));
+    EXPECT_EQ(ctx->cells.count(ctx->id("b")), size_t(0));
+    EXPECT_EQ(cell("d"), d);
+    EXPECT_EQ(users(), std::vector<std::string>({"d.I"}));
+    EXPECT_FALSE(tx.is_removed(ctx->id("a")));
+}
+
+TEST_F(NetlistTransactionTest, nets_erased_on_commit)
+{
+    NetlistTransaction tx(ctx);
+    connect_port(ctx, n, cell("a"), ctx->id("I"), &tx);
+    tx.remove_net(n->name);
+    EXPECT_EQ(ctx->nets.count(ctx->id("n")), size_t(1));
+
+    tx.commit();
+    EXPECT_EQ(ctx->nets.count(ctx->id("n")), size_t(0));
+}
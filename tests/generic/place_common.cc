@@ -0,0 +1,132 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <cstdlib>
+#include <string>
+#include "gtest/gtest.h"
+#include "log.h"
+#include "nextpnr.h"
+#include "place_common.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class PlaceSingleCellTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        log_streams.clear();
+        ctx = new Context(chipArgs);
+        ctx->timing_driven = false;
+        ctx->rngseed(1);
+
+        // A grid of bels of type CELL, one per tile
+        for (int x = 0; x < size; x++)
+            for (int y = 0; y < size; y++)
+                ctx->addBel(bel_name(x, y), ctx->id("CELL"), Loc(x, y, 0), false);
+    }
+
+    virtual void TearDown() { delete ctx; }
+
+    IdString bel_name(int x, int y) { return ctx->id("X" + std::to_string(x) + "/Y" + std::to_string(y)); }
+
+    CellInfo *add_cell(const std::string &name, const char *type)
+    {
+        std::unique_ptr<CellInfo> cell(new CellInfo());
+        cell->name = ctx->id(name);
+        cell->type = ctx->id(type);
+        cell->ports[ctx->id("I")] = PortInfo{ctx->id("I"), nullptr, PORT_IN};
+        cell->ports[ctx->id("O")] = PortInfo{ctx->id("O"), nullptr, PORT_OUT};
+        CellInfo *ptr = cell.get();
+        ctx->cells[cell->name] = std::move(cell);
+        return ptr;
+    }
+
+    void connect(CellInfo *driver, CellInfo *user)
+    {
+        std::unique_ptr<NetInfo> net(new NetInfo());
+        net->name = ctx->id(driver->name.str(ctx) + "_" + user->name.str(ctx));
+        net->driver.cell = driver;
+        net->driver.port = ctx->id("O");
+        PortRef ref;
+        ref.cell = user;
+        ref.port = ctx->id("I");
+        net->users.push_back(ref);
+        driver->ports.at(ctx->id("O")).net = net.get();
+        user->ports.at(ctx->id("I")).net = net.get();
+        ctx->nets[net->name] = std::move(net);
+    }
+
+    void bind(CellInfo *cell, int x, int y, PlaceStrength strength)
+    {
+        ctx->bindBel(ctx->getBelByName(bel_name(x, y)), cell, strength);
+    }
+
+    const int size = 20;
+    ArchArgs chipArgs;
+    Context *ctx;
+};
+
+TEST_F(PlaceSingleCellTest, picks_nearest_free_bel)
+{
+    // A cell connected only to one at (10, 10), with every bel within four
+    // tiles of it taken
+    CellInfo *anchor = add_cell("anchor", "CELL");
+    bind(anchor, 10, 10, STRENGTH_STRONG);
+    for (int x = 6; x <= 14; x++) {
+        for (int y = 6; y <= 14; y++) {
+            if (x == 10 && y == 10)
+                continue;
+            bind(add_cell("fill_" + std::to_string(x) + "_" + std::to_string(y), "CELL"), x, y, STRENGTH_STRONG);
+        }
+    }
+    CellInfo *cell = add_cell("cell", "CELL");
+    connect(anchor, cell);
+
+    ASSERT_TRUE(place_single_cell(ctx, cell, true));
+    ASSERT_NE(cell->bel, BelId());
+    // The ring search stops a few rings after the first one with a free
+    // bel, so the cell must be in one of those, however the random noise
+    // on the cost of each bel falls.
+    Loc loc = ctx->getBelLocation(cell->bel);
+    int radius = std::max(std::abs(loc.x - 10), std::abs(loc.y - 10));
+    EXPECT_GE(radius, 5);
+    EXPECT_LE(radius, 8);
+}
+
+TEST_F(PlaceSingleCellTest, rips_up_when_full)
+{
+    // Every CELL bel is taken, all but one of them strongly. The occupants
+    // are of another type with a free bel of their own, so that the cell
+    // ripped up can be placed again.
+    ctx->addBel(ctx->id("spare"), ctx->id("OTHER"), Loc(0, 0, 1), false);
+    for (int x = 0; x < size; x++) {
+        for (int y = 0; y < size; y++) {
+            bool weak = (x == 3 && y == 7);
+            bind(add_cell("fill_" + std::to_string(x) + "_" + std::to_string(y), "OTHER"), x, y,
+                 weak ? STRENGTH_WEAK : STRENGTH_STRONG);
+        }
+    }
+    CellInfo *cell = add_cell("cell", "CELL");
+
+    ASSERT_TRUE(place_single_cell(ctx, cell, true));
+    EXPECT_EQ(cell->bel, ctx->getBelByName(bel_name(3, 7)));
+    CellInfo *ripped = ctx->cells.at(ctx->id("fill_3_7")).get();
+    EXPECT_EQ(ripped->bel, ctx->getBelByName(ctx->id("spare")));
+    for (auto &other : ctx->cells)
+        EXPECT_NE(other.second->bel, BelId()) << other.first.str(ctx);
+}
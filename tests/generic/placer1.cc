@@ -0,0 +1,148 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "log.h"
+#include "nextpnr.h"
+#include "place_common.h"
+#include "placer1.h"
+#include "settings.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class Placer1Test : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        log_streams.clear();
+        ctx = new Context(chipArgs);
+        ctx->timing_driven = false;
+        ctx->rngseed(1);
+
+        // A grid of tiles with two bels each
+        for (int x = 0; x < size; x++)
+            for (int y = 0; y < size; y++)
+                for (int z = 0; z < 2; z++)
+                    ctx->addBel(ctx->id("X" + std::to_string(x) + "/Y" + std::to_string(y) + "/Z" + std::to_string(z)),
+                                ctx->id("CELL"), Loc(x, y, z), false);
+
+        // Chains of cells stacked upwards on the same z, each cell also
+        // driving an anchor placed by the user in the top right corner, so
+        // that the chains have to move there as a whole. Free cells are
+        // connected in a ring.
+        CellInfo *anchor = add_cell("anchor");
+        anchor->attrs[ctx->id("BEL")] = "X" + std::to_string(size - 1) + "/Y" + std::to_string(size - 1) + "/Z0";
+        for (int i = 0; i < chains; i++) {
+            CellInfo *parent = nullptr;
+            for (int j = 0; j < chain_length; j++) {
+                CellInfo *cell = add_cell("chain" + std::to_string(i) + "_" + std::to_string(j));
+                if (parent != nullptr) {
+                    cell->constr_parent = parent;
+                    cell->constr_x = 0;
+                    cell->constr_y = 1;
+                    cell->constr_z = 0;
+                    parent->constr_children.push_back(cell);
+                }
+                connect(cell, anchor, i * chain_length + j);
+                parent = cell;
+            }
+        }
+        for (int i = 0; i < free_cells; i++)
+            add_cell("free" + std::to_string(i));
+        for (int i = 0; i < free_cells; i++)
+            connect(cell("free" + std::to_string(i)), cell("free" + std::to_string((i + 1) % free_cells)), 0);
+    }
+
+    virtual void TearDown() { delete ctx; }
+
+    CellInfo *add_cell(const std::string &name)
+    {
+        std::unique_ptr<CellInfo> cell(new CellInfo());
+        cell->name = ctx->id(name);
+        cell->type = ctx->id("CELL");
+        for (int i = 0; i < chains * chain_length; i++) {
+            IdString port = ctx->id("I" + std::to_string(i));
+            cell->ports[port] = PortInfo{port, nullptr, PORT_IN};
+        }
+        cell->ports[ctx->id("O")] = PortInfo{ctx->id("O"), nullptr, PORT_OUT};
+        CellInfo *ptr = cell.get();
+        ctx->cells[cell->name] = std::move(cell);
+        return ptr;
+    }
+
+    CellInfo *cell(const std::string &name) { return ctx->cells.at(ctx->id(name)).get(); }
+
+    void connect(CellInfo *driver, CellInfo *user, int input)
+    {
+        std::unique_ptr<NetInfo> net(new NetInfo());
+        net->name = ctx->id(driver->name.str(ctx) + "_O");
+        net->driver.cell = driver;
+        net->driver.port = ctx->id("O");
+        PortRef ref;
+        ref.cell = user;
+        ref.port = ctx->id("I" + std::to_string(input));
+        net->users.push_back(ref);
+        driver->ports.at(ctx->id("O")).net = net.get();
+        user->ports.at(ref.port).net = net.get();
+        ctx->nets[net->name] = std::move(net);
+    }
+
+    // Check that every cell is placed on a bel of its own, with its
+    // relative constraints met
+    void check_legal()
+    {
+        std::unordered_set<BelId> used;
+        for (auto &entry : ctx->cells) {
+            CellInfo *ci = entry.second.get();
+            ASSERT_NE(ci->bel, BelId()) << entry.first.str(ctx);
+            EXPECT_EQ(ctx->getBoundBelCell(ci->bel), ci) << entry.first.str(ctx);
+            EXPECT_TRUE(used.insert(ci->bel).second) << entry.first.str(ctx);
+            EXPECT_EQ(get_constraints_distance(ctx, ci), 0) << entry.first.str(ctx);
+        }
+    }
+
+    const int size = 8, chains = 4, chain_length = 4, free_cells = 40;
+    ArchArgs chipArgs;
+    Context *ctx;
+};
+
+TEST_F(Placer1Test, macro_moves_keep_chains_legal)
+{
+    ASSERT_TRUE(placer1(ctx, Placer1Cfg(ctx)));
+    check_legal();
+
+    // Chains are only ever moved as a whole, and there is no legalisation
+    // after the anneal, so they must have been moved towards the anchor
+    // legally by the annealer.
+    int sum_x = 0;
+    for (int i = 0; i < chains; i++) {
+        CellInfo *root = cell("chain" + std::to_string(i) + "_0");
+        EXPECT_EQ(root->constr_parent, nullptr);
+        sum_x += ctx->getBelLocation(root->bel).x;
+    }
+    EXPECT_GE(sum_x, chains * size / 2);
+}
+
+TEST_F(Placer1Test, adaptive_schedule_is_legal)
+{
+    Settings(ctx).set("placer1/adaptiveSchedule", true);
+    ASSERT_TRUE(placer1(ctx, Placer1Cfg(ctx)));
+    check_legal();
+}
@@ -0,0 +1,115 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "gtest/gtest.h"
+#include "nextpnr.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class RouteDelayTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ctx = new Context(chipArgs);
+
+        // A driver and a sink joined by a fast path through wire f and a slow
+        // path through wire s
+        for (auto wire : {"o", "i", "f", "s"})
+            ctx->addWire(ctx->id(wire), ctx->id("WIRE"), 0, 0);
+        add_pip("of", "o", "f", 1);
+        add_pip("fi", "f", "i", 1);
+        add_pip("os", "o", "s", 10);
+        add_pip("si", "s", "i", 10);
+
+        ctx->addBel(ctx->id("drv"), ctx->id("CELL"), Loc(0, 0, 0), false);
+        ctx->addBelOutput(ctx->id("drv"), ctx->id("O"), ctx->id("o"));
+        ctx->addBel(ctx->id("sink"), ctx->id("CELL"), Loc(0, 0, 1), false);
+        ctx->addBelInput(ctx->id("sink"), ctx->id("I"), ctx->id("i"));
+
+        std::unique_ptr<NetInfo> net(new NetInfo());
+        net->name = ctx->id("net");
+        net->driver.cell = add_cell("drv", ctx->id("O"), PORT_OUT);
+        net->driver.port = ctx->id("O");
+        PortRef user;
+        user.cell = add_cell("sink", ctx->id("I"), PORT_IN);
+        user.port = ctx->id("I");
+        net->users.push_back(user);
+        net->driver.cell->ports.at(ctx->id("O")).net = net.get();
+        user.cell->ports.at(ctx->id("I")).net = net.get();
+        net_info = net.get();
+        ctx->nets[net->name] = std::move(net);
+    }
+
+    virtual void TearDown() { delete ctx; }
+
+    void add_pip(const char *name, const char *src, const char *dst, int delay)
+    {
+        DelayInfo d;
+        d.delay = delay;
+        ctx->addPip(ctx->id(name), ctx->id("PIP"), ctx->id(src), ctx->id(dst), d, Loc(0, 0, 0));
+    }
+
+    CellInfo *add_cell(const char *bel, IdString port, PortType type)
+    {
+        std::unique_ptr<CellInfo> cell(new CellInfo());
+        cell->name = ctx->id(bel);
+        cell->type = ctx->id("CELL");
+        cell->ports[port] = PortInfo{port, nullptr, type};
+        ctx->bindBel(ctx->getBelByName(ctx->id(bel)), cell.get(), STRENGTH_USER);
+        CellInfo *ptr = cell.get();
+        ctx->cells[cell->name] = std::move(cell);
+        return ptr;
+    }
+
+    void route(const char *pip_a, const char *pip_b)
+    {
+        ctx->bindWire(ctx->id("o"), net_info, STRENGTH_WEAK);
+        ctx->bindPip(ctx->id(pip_a), net_info, STRENGTH_WEAK);
+        ctx->bindPip(ctx->id(pip_b), net_info, STRENGTH_WEAK);
+    }
+
+    void ripup(const char *pip_a, const char *pip_b)
+    {
+        ctx->unbindPip(ctx->id(pip_b));
+        ctx->unbindPip(ctx->id(pip_a));
+        ctx->unbindWire(ctx->id("o"));
+    }
+
+    ArchArgs chipArgs;
+    Context *ctx;
+    NetInfo *net_info;
+};
+
+TEST_F(RouteDelayTest, cache_follows_ripup)
+{
+    route("of", "fi");
+    delay_t fast = ctx->getNetinfoRouteDelay(net_info, net_info->users.at(0));
+    ctx->cacheNetinfoRouteDelays(net_info);
+    EXPECT_EQ(net_info->users.at(0).route_gen, net_info->route_gen);
+    EXPECT_EQ(ctx->getNetinfoRouteDelay(net_info, net_info->users.at(0)), fast);
+
+    // Rerouting the net through the slow path must not return the delay
+    // cached for the fast one, whether or not the cache is filled again
+    ripup("of", "fi");
+    EXPECT_NE(net_info->users.at(0).route_gen, net_info->route_gen);
+    route("os", "si");
+    delay_t slow = ctx->getNetinfoRouteDelay(net_info, net_info->users.at(0));
+    EXPECT_GT(slow, fast);
+    ctx->cacheNetinfoRouteDelays(net_info);
+    EXPECT_EQ(ctx->getNetinfoRouteDelay(net_info, net_info->users.at(0)), slow);
+}
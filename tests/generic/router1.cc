@@ -0,0 +1,247 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <sstream>
+#include <vector>
+#include "gtest/gtest.h"
+#include "log.h"
+#include "nextpnr.h"
+#include "router1.h"
+#include "settings.h"
+#include "telemetry.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class Router1Test : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        log_streams.clear();
+        ctx = new Context(chipArgs);
+        ctx->timing_driven = false;
+        ctx->rngseed(1);
+
+        // Pairs of nets a and b contending for one fast wire s. Net a can
+        // only be routed through s, net b also has a slow detour t, so
+        // whenever b is routed first it must be ripped up for a.
+        for (int i = 0; i < 8; i++) {
+            DelayInfo fast, slow;
+            fast.delay = 1;
+            slow.delay = 10;
+            ctx->addWire(name(i, "s"), ctx->id("WIRE"), i, 0);
+            ctx->addWire(name(i, "t"), ctx->id("WIRE"), i, 0);
+            for (auto net : {"a", "b"}) {
+                std::string n(net);
+                ctx->addWire(name(i, n + "_o"), ctx->id("WIRE"), i, 0);
+                ctx->addWire(name(i, n + "_i"), ctx->id("WIRE"), i, 0);
+                ctx->addPip(name(i, n + "_os"), ctx->id("PIP"), name(i, n + "_o"), name(i, "s"), fast, Loc(i, 0, 0));
+                ctx->addPip(name(i, n + "_si"), ctx->id("PIP"), name(i, "s"), name(i, n + "_i"), fast, Loc(i, 0, 0));
+                add_cell(i, n + "_drv", ctx->id("O"), name(i, n + "_o"), PORT_OUT);
+                add_cell(i, n + "_sink", ctx->id("I"), name(i, n + "_i"), PORT_IN);
+                connect(i, n);
+            }
+            ctx->addPip(name(i, "b_ot"), ctx->id("PIP"), name(i, "b_o"), name(i, "t"), slow, Loc(i, 0, 0));
+            ctx->addPip(name(i, "b_ti"), ctx->id("PIP"), name(i, "t"), name(i, "b_i"), slow, Loc(i, 0, 0));
+        }
+    }
+
+    virtual void TearDown() { delete ctx; }
+
+    IdString name(int i, const std::string &suffix) { return ctx->id("X" + std::to_string(i) + "/" + suffix); }
+
+    // A cell with a single port, placed on a bel of its own on the given wire
+    void add_cell(int i, const std::string &suffix, IdString port, IdString wire, PortType type)
+    {
+        IdString bel = name(i, suffix);
+        ctx->addBel(bel, ctx->id("CELL"), Loc(i, 0, int(ctx->cells.size()) % 4), false);
+        if (type == PORT_OUT)
+            ctx->addBelOutput(bel, port, wire);
+        else
+            ctx->addBelInput(bel, port, wire);
+
+        std::unique_ptr<CellInfo> cell(new CellInfo());
+        cell->name = name(i, suffix);
+        cell->type = ctx->id("CELL");
+        cell->ports[port] = PortInfo{port, nullptr, type};
+        ctx->bindBel(ctx->getBelByName(bel), cell.get(), STRENGTH_USER);
+        ctx->cells[cell->name] = std::move(cell);
+    }
+
+    void connect(int i, const std::string &net_name)
+    {
+        std::unique_ptr<NetInfo> net(new NetInfo());
+        net->name = name(i, net_name);
+        net->driver.cell = ctx->cells.at(name(i, net_name + "_drv")).get();
+        net->driver.port = ctx->id("O");
+        PortRef user;
+        user.cell = ctx->cells.at(name(i, net_name + "_sink")).get();
+        user.port = ctx->id("I");
+        net->users.push_back(user);
+        net->driver.cell->ports.at(ctx->id("O")).net = net.get();
+        user.cell->ports.at(ctx->id("I")).net = net.get();
+        ctx->nets[net->name] = std::move(net);
+    }
+
+    ArchArgs chipArgs;
+    Context *ctx;
+};
+
+TEST_F(Router1Test, resolves_contention)
+{
+    ASSERT_TRUE(router1(ctx, Router1Cfg(ctx)));
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(ctx->getBoundWireNet(ctx->getWireByName(name(i, "s")))->name, name(i, "a"));
+        EXPECT_EQ(ctx->getBoundWireNet(ctx->getWireByName(name(i, "t")))->name, name(i, "b"));
+    }
+}
+
+TEST_F(Router1Test, parallel_matches_sequential)
+{
+    // Route one copy of the design with batches of nets searched on four
+    // threads and one on a single thread. Bounding boxes are needed for
+    // nets to be batched; the pairs contending for a wire share one, so
+    // each batch holds one net from each of several pairs.
+    std::unique_ptr<Context> seq = ctx->clone();
+    Settings(ctx).set("router1/bbMargin", 0);
+    Settings(ctx).set("router1/threads", 4);
+    Settings(seq.get()).set("router1/bbMargin", 0);
+    Settings(seq.get()).set("router1/threads", 1);
+    telemetry_reset();
+    ASSERT_TRUE(router1(ctx, Router1Cfg(ctx)));
+    std::ostringstream report;
+    telemetry_write_json(report);
+    EXPECT_NE(report.str().find("\"route/batched_jobs\""), std::string::npos);
+    ASSERT_TRUE(router1(seq.get(), Router1Cfg(seq.get())));
+
+    for (auto &net : ctx->nets) {
+        const NetInfo *seq_net = seq->nets.at(net.first).get();
+        ASSERT_EQ(net.second->wires.size(), seq_net->wires.size()) << net.first.str(ctx);
+        for (auto &wire : net.second->wires) {
+            auto fnd = seq_net->wires.find(wire.first);
+            ASSERT_TRUE(fnd != seq_net->wires.end()) << net.first.str(ctx);
+            EXPECT_EQ(wire.second.pip, fnd->second.pip) << net.first.str(ctx);
+        }
+    }
+}
+
+#ifndef NO_GUI
+TEST_F(Router1Test, ripup_reports_congestion)
+{
+    ctx->uiSnapshotEnabled = true;
+    ASSERT_TRUE(router1(ctx, Router1Cfg(ctx)));
+
+    std::vector<std::pair<WireId, int>> congestion = ctx->congestionUiReload;
+    for (auto &snapshot : ctx->takeUiSnapshots())
+        congestion.insert(congestion.end(), snapshot.congestion.begin(), snapshot.congestion.end());
+    EXPECT_FALSE(congestion.empty());
+}
+#endif
+
+class Router1NetTreeTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        log_streams.clear();
+        ctx = new Context(chipArgs);
+        ctx->timing_driven = false;
+        ctx->rngseed(1);
+
+        // One net driving a user in each of a row of tiles, off a spine of
+        // wires that runs along the row, with a slow direct pip from the
+        // driver to every third user
+        DelayInfo fast, slow;
+        fast.delay = 1;
+        slow.delay = 50;
+        ctx->addWire(ctx->id("o"), ctx->id("WIRE"), 0, 0);
+        add_bel("drv", ctx->id("O"), ctx->id("o"), PORT_OUT, 0);
+        std::unique_ptr<NetInfo> net(new NetInfo());
+        net->name = ctx->id("net");
+        net->driver.cell = ctx->cells.at(ctx->id("drv")).get();
+        net->driver.port = ctx->id("O");
+        net->driver.cell->ports.at(ctx->id("O")).net = net.get();
+
+        for (int i = 0; i < users; i++) {
+            IdString spine = name(i, "w"), sink = name(i, "i");
+            ctx->addWire(spine, ctx->id("WIRE"), i, 0);
+            ctx->addWire(sink, ctx->id("WIRE"), i, 0);
+            IdString prev = i == 0 ? ctx->id("o") : name(i - 1, "w");
+            ctx->addPip(name(i, "spine"), ctx->id("PIP"), prev, spine, fast, Loc(i, 0, 0));
+            ctx->addPip(name(i, "sink"), ctx->id("PIP"), spine, sink, fast, Loc(i, 0, 0));
+            if (i % 3 == 2)
+                ctx->addPip(name(i, "direct"), ctx->id("PIP"), ctx->id("o"), sink, slow, Loc(i, 0, 0));
+
+            add_bel(name(i, "sink").str(ctx), ctx->id("I"), sink, PORT_IN, i);
+            PortRef user;
+            user.cell = ctx->cells.at(name(i, "sink")).get();
+            user.port = ctx->id("I");
+            user.cell->ports.at(ctx->id("I")).net = net.get();
+            net->users.push_back(user);
+        }
+        net_info = net.get();
+        ctx->nets[net->name] = std::move(net);
+    }
+
+    virtual void TearDown() { delete ctx; }
+
+    IdString name(int i, const std::string &suffix) { return ctx->id("X" + std::to_string(i) + "/" + suffix); }
+
+    // A bel with a single pin on the given wire, and a cell bound to it
+    void add_bel(const std::string &bel_name, IdString port, IdString wire, PortType type, int x)
+    {
+        IdString bel = ctx->id(bel_name);
+        ctx->addBel(bel, ctx->id("CELL"), Loc(x, 0, type == PORT_OUT ? 1 : 0), false);
+        if (type == PORT_OUT)
+            ctx->addBelOutput(bel, port, wire);
+        else
+            ctx->addBelInput(bel, port, wire);
+
+        std::unique_ptr<CellInfo> cell(new CellInfo());
+        cell->name = bel;
+        cell->type = ctx->id("CELL");
+        cell->ports[port] = PortInfo{port, nullptr, type};
+        ctx->bindBel(bel, cell.get(), STRENGTH_USER);
+        ctx->cells[cell->name] = std::move(cell);
+    }
+
+    const int users = 8;
+    ArchArgs chipArgs;
+    Context *ctx;
+    NetInfo *net_info;
+};
+
+TEST_F(Router1NetTreeTest, routes_every_user)
+{
+    Settings(ctx).set("router1/netTree", true);
+    ASSERT_TRUE(router1(ctx, Router1Cfg(ctx)));
+
+    // Every user must be reached from the driver through the net's wires
+    WireId src_wire = ctx->getWireByName(ctx->id("o"));
+    for (auto &user : net_info->users) {
+        WireId cursor = ctx->getNetinfoSinkWire(net_info, user);
+        int hops = 0;
+        while (cursor != src_wire) {
+            auto fnd = net_info->wires.find(cursor);
+            ASSERT_TRUE(fnd != net_info->wires.end()) << user.cell->name.str(ctx);
+            ASSERT_NE(fnd->second.pip, PipId()) << user.cell->name.str(ctx);
+            EXPECT_EQ(ctx->getBoundWireNet(cursor), net_info);
+            cursor = ctx->getPipSrcWire(fnd->second.pip);
+            ASSERT_LE(++hops, 2 * users) << user.cell->name.str(ctx);
+        }
+    }
+}
@@ -120,3 +120,38 @@ TEST_F(QuadTreeTest, insert_retrieve_same)
         ASSERT_TRUE(found);
     }
 }
+
+// Test that bulk insertion finds the same elements as repeated insertion.
+TEST_F(QuadTreeTest, bulk_insert_retrieve_same)
+{
+    auto rng = NEXTPNR_NAMESPACE::DeterministicRNG();
+    QT bulk(QT::BoundingBox(0, 0, width_, height_));
+
+    // Add 10000 small random rectangles to both trees.
+    rng.rngseed(0);
+    std::vector<std::pair<QT::BoundingBox, int>> elems;
+    for (int i = 0; i < 10000; i++) {
+        int x0 = rng.rng(width_);
+        int y0 = rng.rng(height_);
+        int w = rng.rng(width_ - x0);
+        int h = rng.rng(width_ - y0);
+        int x1 = x0 + w / 4;
+        int y1 = y0 + h / 4;
+        ASSERT_TRUE(qt_->insert(QT::BoundingBox(x0, y0, x1, y1), i));
+        elems.push_back(std::make_pair(QT::BoundingBox(x0, y0, x1, y1), i));
+    }
+    ASSERT_TRUE(bulk.bulk_insert(elems));
+    ASSERT_EQ(bulk.size(), qt_->size());
+    ASSERT_FALSE(bulk.bulk_insert({std::make_pair(QT::BoundingBox(10, 10, 101, 20), 0)}));
+    ASSERT_EQ(bulk.size(), qt_->size());
+
+    for (int x = 0; x < width_; x += 3) {
+        for (int y = 0; y < height_; y += 3) {
+            auto res = qt_->get(x, y);
+            auto bulk_res = bulk.get(x, y);
+            std::sort(res.begin(), res.end());
+            std::sort(bulk_res.begin(), bulk_res.end());
+            ASSERT_EQ(res, bulk_res);
+        }
+    }
+}
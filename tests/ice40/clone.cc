@@ -0,0 +1,117 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <vector>
+#include "gtest/gtest.h"
+#include "nextpnr.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class CloneTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        chipArgs.type = ArchArgs::HX1K;
+        chipArgs.package = "tq144";
+        ctx = new Context(chipArgs);
+
+        // Two logic cells, the first driving the second, placed on the first
+        // two logic bels with the driver's output wire bound.
+        for (int i = 0; i < 2; i++) {
+            std::unique_ptr<CellInfo> cell(new CellInfo());
+            cell->name = ctx->id("lc" + std::to_string(i));
+            cell->type = ctx->id("ICESTORM_LC");
+            cell->ports[ctx->id("O")] = PortInfo{ctx->id("O"), nullptr, PORT_OUT};
+            cell->ports[ctx->id("I0")] = PortInfo{ctx->id("I0"), nullptr, PORT_IN};
+            cells.push_back(cell.get());
+            ctx->cells[cell->name] = std::move(cell);
+        }
+        std::unique_ptr<NetInfo> net(new NetInfo());
+        net->name = ctx->id("net");
+        net->driver.cell = cells.at(0);
+        net->driver.port = ctx->id("O");
+        PortRef user;
+        user.cell = cells.at(1);
+        user.port = ctx->id("I0");
+        net->users.push_back(user);
+        cells.at(0)->ports.at(ctx->id("O")).net = net.get();
+        cells.at(1)->ports.at(ctx->id("I0")).net = net.get();
+        ctx->nets[net->name] = std::move(net);
+        ctx->assignArchInfo();
+
+        for (auto bel : ctx->getBels()) {
+            if (ctx->getBelType(bel) != ctx->id("ICESTORM_LC"))
+                continue;
+            ctx->bindBel(bel, cells.at(bels.size()), STRENGTH_WEAK);
+            bels.push_back(bel);
+            if (bels.size() == cells.size())
+                break;
+        }
+        source = ctx->getNetinfoSourceWire(ctx->nets.at(ctx->id("net")).get());
+        ctx->bindWire(source, ctx->nets.at(ctx->id("net")).get(), STRENGTH_WEAK);
+    }
+
+    virtual void TearDown() { delete ctx; }
+
+    ArchArgs chipArgs;
+    Context *ctx;
+    std::vector<CellInfo *> cells;
+    std::vector<BelId> bels;
+    WireId source;
+};
+
+TEST_F(CloneTest, same_design)
+{
+    std::unique_ptr<Context> copy = ctx->clone();
+    ASSERT_EQ(ctx->checksum(), copy->checksum());
+    copy->check();
+    ASSERT_EQ(copy->id("lc1").index, ctx->id("lc1").index);
+    ASSERT_EQ(copy->cells.size(), ctx->cells.size());
+    ASSERT_EQ(copy->nets.size(), ctx->nets.size());
+}
+
+TEST_F(CloneTest, pointers_remapped)
+{
+    std::unique_ptr<Context> copy = ctx->clone();
+    CellInfo *driver = copy->cells.at(copy->id("lc0")).get();
+    CellInfo *sink = copy->cells.at(copy->id("lc1")).get();
+    NetInfo *net = copy->nets.at(copy->id("net")).get();
+    ASSERT_NE(driver, cells.at(0));
+    ASSERT_EQ(net->driver.cell, driver);
+    ASSERT_EQ(net->users.at(0).cell, sink);
+    ASSERT_EQ(driver->ports.at(copy->id("O")).net, net);
+    ASSERT_EQ(sink->ports.at(copy->id("I0")).net, net);
+    ASSERT_EQ(copy->getBoundBelCell(bels.at(0)), driver);
+    ASSERT_EQ(copy->getBoundWireNet(source), net);
+}
+
+TEST_F(CloneTest, independent)
+{
+    std::unique_ptr<Context> copy = ctx->clone();
+    copy->unbindWire(source);
+    copy->unbindBel(bels.at(1));
+    copy->id("only_in_copy");
+    ASSERT_TRUE(copy->checkBelAvail(bels.at(1)));
+    ASSERT_FALSE(ctx->checkBelAvail(bels.at(1)));
+    ASSERT_EQ(ctx->getBoundWireNet(source), ctx->nets.at(ctx->id("net")).get());
+    ASSERT_EQ(ctx->idstring_str_to_idx->count("only_in_copy"), size_t(0));
+    ctx->check();
+
+    copy.reset();
+    ASSERT_EQ(ctx->getBoundBelCell(bels.at(1)), cells.at(1));
+}
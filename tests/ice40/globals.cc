@@ -0,0 +1,115 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <set>
+#include <sstream>
+#include <vector>
+#include "cells.h"
+#include "gtest/gtest.h"
+#include "log.h"
+#include "nextpnr.h"
+#include "telemetry.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class GlobalsTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        log_streams.clear();
+        chipArgs.type = ArchArgs::HX1K;
+        chipArgs.package = "tq144";
+        ctx = new Context(chipArgs);
+        ctx->timing_driven = false;
+
+        // A global buffer driving the clocks of logic cells in tiles spread
+        // over the device
+        std::unique_ptr<CellInfo> gb = create_ice_cell(ctx, id_SB_GB, "gb");
+        std::unique_ptr<NetInfo> net(new NetInfo());
+        net->name = ctx->id("clk");
+        net->driver.cell = gb.get();
+        net->driver.port = id_GLOBAL_BUFFER_OUTPUT;
+        gb->ports.at(id_GLOBAL_BUFFER_OUTPUT).net = net.get();
+        for (auto bel : ctx->getBels()) {
+            if (ctx->getBelType(bel) == id_SB_GB) {
+                ctx->bindBel(bel, gb.get(), STRENGTH_USER);
+                break;
+            }
+        }
+        ctx->cells[gb->name] = std::move(gb);
+
+        std::set<std::pair<int, int>> tiles;
+        for (auto bel : ctx->getBels()) {
+            Loc loc = ctx->getBelLocation(bel);
+            if (ctx->getBelType(bel) != id_ICESTORM_LC || (loc.x + loc.y) % 5 != 0 ||
+                !tiles.insert(std::make_pair(loc.x, loc.y)).second)
+                continue;
+            std::unique_ptr<CellInfo> lc = create_ice_cell(ctx, id_ICESTORM_LC, "lc" + std::to_string(tiles.size()));
+            lc->params[ctx->id("DFF_ENABLE")] = "1";
+            lc->ports.at(id_CLK).net = net.get();
+            PortRef user;
+            user.cell = lc.get();
+            user.port = id_CLK;
+            net->users.push_back(user);
+            ctx->bindBel(bel, lc.get(), STRENGTH_USER);
+            ctx->cells[lc->name] = std::move(lc);
+        }
+        net_info = net.get();
+        ctx->nets[net->name] = std::move(net);
+        ctx->assignArchInfo();
+    }
+
+    virtual void TearDown() { delete ctx; }
+
+    int wire_type(WireId wire) { return ctx->chip_info->wire_data[wire.index].type; }
+
+    ArchArgs chipArgs;
+    Context *ctx;
+    NetInfo *net_info;
+};
+
+TEST_F(GlobalsTest, routed_without_router1_jobs)
+{
+    ASSERT_GT(net_info->users.size(), size_t(10));
+    telemetry_reset();
+    ASSERT_TRUE(ctx->route());
+
+    // Every user is reached from the buffer over the global network only,
+    // by the global routing pass, leaving no job for router1
+    WireId src_wire = ctx->getNetinfoSourceWire(net_info);
+    for (auto &user : net_info->users) {
+        WireId cursor = ctx->getNetinfoSinkWire(net_info, user);
+        while (cursor != src_wire) {
+            auto fnd = net_info->wires.find(cursor);
+            ASSERT_TRUE(fnd != net_info->wires.end()) << user.cell->name.str(ctx);
+            ASSERT_NE(fnd->second.pip, PipId()) << user.cell->name.str(ctx);
+            EXPECT_EQ(fnd->second.strength, STRENGTH_LOCKED) << ctx->getWireName(cursor).str(ctx);
+            cursor = ctx->getPipSrcWire(fnd->second.pip);
+        }
+    }
+    for (auto &wire : net_info->wires)
+        EXPECT_TRUE(wire_type(wire.first) == WireInfoPOD::WIRE_TYPE_GLB_NETWK ||
+                    wire_type(wire.first) == WireInfoPOD::WIRE_TYPE_GLB2LOCAL ||
+                    wire_type(wire.first) == WireInfoPOD::WIRE_TYPE_LUTFF_GLOBAL)
+                << ctx->getWireName(wire.first).str(ctx);
+
+    // router1 only reports jobs once it has found some to run
+    std::ostringstream report;
+    telemetry_write_json(report);
+    EXPECT_EQ(report.str().find("\"route/jobs\""), std::string::npos) << report.str();
+}
@@ -0,0 +1,157 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <map>
+#include <vector>
+#include "gtest/gtest.h"
+#include "nextpnr.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class LogicTileTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        chipArgs.type = ArchArgs::HX1K;
+        chipArgs.package = "tq144";
+        ctx = new Context(chipArgs);
+        ctx->rngseed(1);
+
+        // Control nets, some global and some on local routing
+        for (int i = 0; i < 4; i++) {
+            std::unique_ptr<NetInfo> net(new NetInfo());
+            net->name = ctx->id("ctrl" + std::to_string(i));
+            net->is_global = (i % 2) == 0;
+            nets.push_back(net.get());
+            ctx->nets[net->name] = std::move(net);
+        }
+
+        // Logic cells with random LUT input counts and DFF control sets, drawn
+        // from few enough choices that tiles both share and conflict
+        for (int i = 0; i < 48; i++) {
+            std::unique_ptr<CellInfo> cell(new CellInfo());
+            cell->name = ctx->id("lc" + std::to_string(i));
+            cell->type = ctx->id("ICESTORM_LC");
+            cell->lcInfo.dffEnable = ctx->rng(3) != 0;
+            cell->lcInfo.carryEnable = false;
+            cell->lcInfo.negClk = ctx->rng(4) == 0;
+            cell->lcInfo.inputCount = ctx->rng(5);
+            cell->lcInfo.clk = random_net(2);
+            cell->lcInfo.cen = random_net(3);
+            cell->lcInfo.sr = random_net(3);
+            cells.push_back(cell.get());
+            ctx->cells[cell->name] = std::move(cell);
+        }
+
+        for (auto bel : ctx->getBels()) {
+            if (ctx->getBelType(bel) != ctx->id("ICESTORM_LC"))
+                continue;
+            Loc loc = ctx->getBelLocation(bel);
+            auto key = std::make_pair(loc.x, loc.y);
+            if (!tiles.count(key) && tiles.size() == 4)
+                continue;
+            tiles[key].push_back(bel);
+        }
+    }
+
+    virtual void TearDown() { delete ctx; }
+
+    const NetInfo *random_net(int choices)
+    {
+        int i = ctx->rng(choices + 1);
+        return i == 0 ? nullptr : nets.at(i - 1);
+    }
+
+    // The reference answer: every cell in the tile, with cell in place of
+    // whatever is bound to bel if cell is not null
+    bool compatible(const std::vector<BelId> &tile, BelId bel, const CellInfo *cell)
+    {
+        std::vector<const CellInfo *> tile_cells;
+        for (auto bel_other : tile) {
+            const CellInfo *ci = ctx->getBoundBelCell(bel_other);
+            if (cell != nullptr && bel_other == bel)
+                ci = cell;
+            if (ci != nullptr)
+                tile_cells.push_back(ci);
+        }
+        return ctx->logicCellsCompatible(tile_cells.data(), tile_cells.size());
+    }
+
+    // The reference answer for a swap: every cell in the tile, with the bound
+    // cell cell and the cell bound to bel, if any, trading places
+    bool swap_compatible(const std::vector<BelId> &tile, BelId bel, const CellInfo *cell)
+    {
+        std::vector<const CellInfo *> tile_cells;
+        for (auto bel_other : tile) {
+            const CellInfo *ci = ctx->getBoundBelCell(bel_other);
+            if (bel_other == bel)
+                ci = cell;
+            else if (bel_other == cell->bel)
+                ci = ctx->getBoundBelCell(bel);
+            if (ci != nullptr)
+                tile_cells.push_back(ci);
+        }
+        return ctx->logicCellsCompatible(tile_cells.data(), tile_cells.size());
+    }
+
+    ArchArgs chipArgs;
+    Context *ctx;
+    std::vector<NetInfo *> nets;
+    std::vector<CellInfo *> cells;
+    std::map<std::pair<int, int>, std::vector<BelId>> tiles;
+};
+
+TEST_F(LogicTileTest, random_bind_unbind)
+{
+    ASSERT_EQ(tiles.size(), size_t(4));
+    std::vector<BelId> bels;
+    for (auto &tile : tiles)
+        bels.insert(bels.end(), tile.second.begin(), tile.second.end());
+
+    for (int step = 0; step < 2000; step++) {
+        BelId bel = bels.at(ctx->rng(int(bels.size())));
+        if (ctx->getBoundBelCell(bel) != nullptr) {
+            ctx->unbindBel(bel);
+        } else {
+            CellInfo *cell = cells.at(ctx->rng(int(cells.size())));
+            if (cell->bel != BelId())
+                ctx->unbindBel(cell->bel);
+            ctx->bindBel(bel, cell, STRENGTH_WEAK);
+        }
+
+        for (auto &tile : tiles) {
+            for (auto tile_bel : tile.second) {
+                ASSERT_EQ(ctx->isBelLocationValid(tile_bel), compatible(tile.second, tile_bel, nullptr))
+                        << "step " << step;
+                for (auto cell : cells) {
+                    if (cell->bel != BelId() && cell->bel != tile_bel)
+                        continue;
+                    ASSERT_EQ(ctx->isValidBelForCell(cell, tile_bel), compatible(tile.second, tile_bel, cell))
+                            << "step " << step << " cell " << cell->name.str(ctx);
+                }
+                for (auto cell : cells) {
+                    if (cell->bel == BelId() || cell->bel == tile_bel)
+                        continue;
+                    ASSERT_EQ(ctx->isValidBelForCell(cell, tile_bel, ctx->getBoundBelCell(tile_bel)),
+                              swap_compatible(tile.second, tile_bel, cell))
+                            << "step " << step << " swap " << cell->name.str(ctx);
+                }
+            }
+        }
+    }
+}